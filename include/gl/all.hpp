@@ -58,4 +58,15 @@
 // Extension - Texture handles.
 #include <gl/texture_handle.hpp>
 
+// X Extended Functionality - Instrumentation.
+#include <gl/instrumentation.hpp>
+// X Extended Functionality - Spans.
+#include <gl/span.hpp>
+// X Extended Functionality - Small buffers.
+#include <gl/small_buffer.hpp>
+// X Extended Functionality - State cache.
+#include <gl/state_cache.hpp>
+// X Extended Functionality - Render state objects.
+#include <gl/render_state.hpp>
+
 #endif
@@ -0,0 +1,246 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_AUXILIARY_BARRIER_TRACKER_HPP
+#define GL_AUXILIARY_BARRIER_TRACKER_HPP
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <gl/opengl.hpp>
+#include <gl/buffer.hpp>
+#include <gl/draw_commands.hpp>
+#include <gl/texture.hpp>
+
+namespace gl
+{
+// How a texture is read by the next command.
+enum class texture_access
+{
+  sampled    , // Texture fetches, including texelFetch.
+  image      , // Image loads / stores / atomics.
+  framebuffer, // Rendering to or blending with it as an attachment.
+  update     , // Texture updates and reads by commands, e.g. set_sub_image, sub_image, copy_image_sub_data.
+  feedback     // Sampling it while it is attached to the draw framebuffer, after rendering to it.
+};
+
+struct barrier_tracker_statistics
+{
+  std::size_t commands         = 0; // Calls to barrier().
+  std::size_t memory_barriers  = 0;
+  std::size_t region_barriers  = 0;
+  std::size_t texture_barriers = 0;
+  std::size_t avoided          = 0; // Commands which needed no barrier at all.
+
+  [[nodiscard]]
+  double avoided_ratio() const
+  {
+    return commands > 0 ? static_cast<double>(avoided) / static_cast<double>(commands) : 0.0;
+  }
+};
+
+// Issues the minimal memory barriers between incoherent shader writes (shader storage, atomic counters, image stores) and later
+// reads. Before each draw or dispatch, declare the resources it reads with read() and those its shaders write with write() (and
+// attachments it renders to with render_to()), then call barrier(): it issues a single memory_barrier (or memory_barrier_by_region)
+// with the bits of the reads which follow a write not yet made visible by an earlier barrier of that bit, a texture_barrier for
+// feedback reads of textures rendered since the last one, and nothing if there is no hazard. Shader writes following shader
+// writes to the same resource are ordered as well. The writes take effect after the barrier, as they are performed by the command.
+// Each barrier bit keeps the serial of the last write it covered, hence checking a read is constant time.
+class barrier_tracker
+{
+public:
+  barrier_tracker           ()                             = default;
+  barrier_tracker           (const barrier_tracker&  that) = delete;
+  barrier_tracker           (      barrier_tracker&& temp) = default;
+  virtual ~barrier_tracker  ()                             = default;
+  barrier_tracker& operator=(const barrier_tracker&  that) = delete;
+  barrier_tracker& operator=(      barrier_tracker&& temp) = default;
+
+  // The buffer target describes the read, e.g. GL_SHADER_STORAGE_BUFFER, GL_DRAW_INDIRECT_BUFFER or GL_ARRAY_BUFFER.
+  // GL_COPY_READ_BUFFER stands for reads by buffer commands, e.g. copy_sub_data or sub_data.
+  void read     (const buffer&      value, const GLenum         target)
+  {
+    require(key(false, value.id()), buffer_bit(target));
+  }
+  void read     (const texture_ref& value, const texture_access access)
+  {
+    const auto found = states_.find(key(true, value.id()));
+    if (found == states_.end())
+      return;
+    if (access == texture_access::feedback)
+    {
+      feedback_ = feedback_ || found->second.rendered > texture_barrier_serial_;
+      return;
+    }
+    require(found->first, texture_bit(access));
+  }
+  // Writes through shader storage, atomic counters or image stores into a texture buffer.
+  void write    (const buffer&      value)
+  {
+    const auto resource = key(false, value.id());
+    require(resource, GL_SHADER_STORAGE_BARRIER_BIT);
+    writes_.push_back(write_entry {resource, false});
+  }
+  // Writes through image stores.
+  void write    (const texture_ref& value)
+  {
+    const auto resource = key(true, value.id());
+    require(resource, GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    writes_.push_back(write_entry {resource, false});
+  }
+  // Rendering into the texture as an attachment, which only feedback reads need a barrier for.
+  void render_to(const texture_ref& value)
+  {
+    writes_.push_back(write_entry {key(true, value.id()), true});
+  }
+
+  // Issues the barriers the declared accesses need and applies the declared writes. by_region restricts the memory barrier to
+  // the framebuffer regions of the fragments, for reads by fragment shaders only; it is ignored if a bit does not support it.
+  // Returns the memory barrier bits issued.
+  GLbitfield barrier(const bool by_region = false)
+  {
+    ++statistics_.commands;
+
+    const auto bits = required_;
+    if (bits != 0)
+    {
+      if (by_region && (bits & ~region_bits) == 0)
+      {
+        memory_barrier_by_region(bits);
+        ++statistics_.region_barriers;
+      }
+      else
+      {
+        memory_barrier(bits);
+        ++statistics_.memory_barriers;
+      }
+      for (std::size_t i = 0; i < covered_.size(); ++i)
+        if (bits & (1u << i))
+          covered_[i] = serial_;
+    }
+    if (feedback_)
+    {
+      texture_barrier();
+      texture_barrier_serial_ = serial_;
+      ++statistics_.texture_barriers;
+    }
+    if (bits == 0 && !feedback_)
+      ++statistics_.avoided;
+
+    ++serial_;
+    for (const auto& value : writes_)
+      (value.rendered ? states_[value.resource].rendered : states_[value.resource].written) = serial_;
+
+    required_ = 0;
+    feedback_ = false;
+    writes_.clear();
+    return bits;
+  }
+
+  // Forgets a resource, e.g. before it is destroyed, as its name may be reused.
+  void forget(const buffer&      value)
+  {
+    states_.erase(key(false, value.id()));
+  }
+  void forget(const texture_ref& value)
+  {
+    states_.erase(key(true , value.id()));
+  }
+  // Forgets every resource, e.g. after an external memory_barrier(GL_ALL_BARRIER_BITS).
+  void reset ()
+  {
+    states_.clear();
+  }
+
+  [[nodiscard]]
+  const barrier_tracker_statistics& statistics      () const
+  {
+    return statistics_;
+  }
+  void                              reset_statistics()
+  {
+    statistics_ = barrier_tracker_statistics();
+  }
+
+protected:
+  static constexpr GLbitfield region_bits = GL_ATOMIC_COUNTER_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT |
+                                            GL_SHADER_STORAGE_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_UNIFORM_BARRIER_BIT;
+
+  struct state
+  {
+    std::uint64_t written  = 0; // Serial of the last shader write.
+    std::uint64_t rendered = 0; // Serial of the last render to it as an attachment.
+  };
+  struct write_entry
+  {
+    std::uint64_t resource;
+    bool          rendered;
+  };
+
+  static std::uint64_t key        (const bool texture, const GLuint id)
+  {
+    return (static_cast<std::uint64_t>(texture) << 32) | id;
+  }
+  static GLbitfield    buffer_bit (const GLenum target)
+  {
+    switch (target)
+    {
+    case GL_ARRAY_BUFFER             : return GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT;
+    case GL_ELEMENT_ARRAY_BUFFER     : return GL_ELEMENT_ARRAY_BARRIER_BIT;
+    case GL_UNIFORM_BUFFER           : return GL_UNIFORM_BARRIER_BIT;
+    case GL_DRAW_INDIRECT_BUFFER     :
+    case GL_DISPATCH_INDIRECT_BUFFER :
+    case GL_PARAMETER_BUFFER         : return GL_COMMAND_BARRIER_BIT;
+    case GL_PIXEL_PACK_BUFFER        :
+    case GL_PIXEL_UNPACK_BUFFER      : return GL_PIXEL_BUFFER_BARRIER_BIT;
+    case GL_TEXTURE_BUFFER           : return GL_TEXTURE_FETCH_BARRIER_BIT;
+    case GL_COPY_READ_BUFFER         :
+    case GL_COPY_WRITE_BUFFER        : return GL_BUFFER_UPDATE_BARRIER_BIT;
+    case GL_TRANSFORM_FEEDBACK_BUFFER: return GL_TRANSFORM_FEEDBACK_BARRIER_BIT;
+    case GL_ATOMIC_COUNTER_BUFFER    : return GL_ATOMIC_COUNTER_BARRIER_BIT;
+    case GL_SHADER_STORAGE_BUFFER    : return GL_SHADER_STORAGE_BARRIER_BIT;
+    case GL_QUERY_BUFFER             : return GL_QUERY_BUFFER_BARRIER_BIT;
+    default:
+      assert(false && "Unsupported buffer target!");
+      return GL_ALL_BARRIER_BITS;
+    }
+  }
+  static GLbitfield    texture_bit(const texture_access access)
+  {
+    switch (access)
+    {
+    case texture_access::sampled    : return GL_TEXTURE_FETCH_BARRIER_BIT;
+    case texture_access::image      : return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+    case texture_access::framebuffer: return GL_FRAMEBUFFER_BARRIER_BIT;
+    default                         : return GL_TEXTURE_UPDATE_BARRIER_BIT;
+    }
+  }
+
+  void require(const std::uint64_t resource, const GLbitfield bits)
+  {
+    const auto found = states_.find(resource);
+    if (found == states_.end() || found->second.written == 0)
+      return;
+    for (std::size_t i = 0; i < covered_.size(); ++i)
+      if ((bits & (1u << i)) && covered_[i] < found->second.written)
+        required_ |= (1u << i);
+  }
+
+  std::unordered_map<std::uint64_t, state> states_                ;
+  std::array<std::uint64_t, 32>            covered_               {}; // Per barrier bit, the serial of the last write it made visible.
+  std::uint64_t                            texture_barrier_serial_ = 0;
+  std::uint64_t                            serial_                 = 0;
+  GLbitfield                               required_               = 0;
+  bool                                     feedback_               = false;
+  std::vector<write_entry>                 writes_                ;
+  barrier_tracker_statistics               statistics_            ;
+};
+}
+
+#endif
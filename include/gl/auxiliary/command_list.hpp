@@ -0,0 +1,518 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_AUXILIARY_COMMAND_LIST_HPP
+#define GL_AUXILIARY_COMMAND_LIST_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include <gl/opengl.hpp>
+#include <gl/buffer.hpp>
+#include <gl/compute.hpp>
+#include <gl/draw_commands.hpp>
+#include <gl/framebuffer.hpp>
+#include <gl/program.hpp>
+#include <gl/render_state.hpp>
+#include <gl/sampler.hpp>
+#include <gl/span.hpp>
+#include <gl/state_cache.hpp>
+#include <gl/texture.hpp>
+#include <gl/vertex_array.hpp>
+#include <gl/viewport.hpp>
+
+namespace gl
+{
+// Records commands into a linear arena without touching GL, so that lists can be filled on any thread (one thread per list at
+// a time) and executed later, in order, on the thread of the context. The recorded objects are referenced, not copied, and
+// must outlive the execution. Executing goes through a state cache, which drops binds and state changes that are already in
+// place; uniform writes are additionally filtered by the uniform shadow of the program, if enabled. reset() keeps the capacity
+// of the arena, hence a list reused every frame stops allocating once it has reached its peak size.
+class command_list
+{
+public:
+  command_list           ()                          = default;
+  command_list           (const command_list&  that) = default;
+  command_list           (      command_list&& temp) = default;
+  virtual ~command_list  ()                          = default;
+  command_list& operator=(const command_list&  that) = default;
+  command_list& operator=(      command_list&& temp) = default;
+
+  // Binds.
+  void use_program          (const program&      program)
+  {
+    push<object_command<program_type>>(command_type::use_program, &program);
+  }
+  void bind_vertex_array    (const vertex_array& vertex_array)
+  {
+    push<object_command<gl::vertex_array>>(command_type::bind_vertex_array, &vertex_array);
+  }
+  void bind_framebuffer     (const framebuffer&  framebuffer, const GLenum target = GL_FRAMEBUFFER)
+  {
+    push<framebuffer_command>(command_type::bind_framebuffer, &framebuffer, target);
+  }
+  void unbind_framebuffer   (                                 const GLenum target = GL_FRAMEBUFFER)
+  {
+    push<framebuffer_command>(command_type::bind_framebuffer, nullptr, target);
+  }
+  void bind_buffer          (const buffer&       buffer, const GLenum target)
+  {
+    push<buffer_command>(command_type::bind_buffer, &buffer, target, 0u, 0, 0);
+  }
+  void bind_buffer_base     (const buffer&       buffer, const GLenum target, const GLuint index)
+  {
+    push<buffer_command>(command_type::bind_buffer_base, &buffer, target, index, 0, 0);
+  }
+  void bind_buffer_range    (const buffer&       buffer, const GLenum target, const GLuint index, const GLintptr offset, const GLsizeiptr size)
+  {
+    push<buffer_command>(command_type::bind_buffer_range, &buffer, target, index, offset, size);
+  }
+  void bind_textures        (const GLuint first, const span<const texture_ref> textures)
+  {
+    push_array<range_command>(command_type::bind_textures      , textures, first, 0u);
+  }
+  void bind_image_textures  (const GLuint first, const span<const texture_ref> textures)
+  {
+    push_array<range_command>(command_type::bind_image_textures, textures, first, 0u);
+  }
+  void bind_samplers        (const GLuint first, const span<const sampler_ref> samplers)
+  {
+    push_array<range_command>(command_type::bind_samplers      , samplers, first, 0u);
+  }
+  void bind_buffers_range   (const GLenum target, const GLuint first, const span<const buffer_range> ranges)
+  {
+    push_array<range_command>(command_type::bind_buffers_range , ranges  , first, target);
+  }
+
+  // State.
+  void apply_render_state   (const render_state& state)
+  {
+    push<value_command<render_state>>(command_type::apply_render_state, state);
+  }
+  void set_viewport         (const std::array<GLint, 2>& offset, const std::array<GLsizei, 2>& size)
+  {
+    push<value_command<std::array<GLint, 4>>>(command_type::set_viewport, std::array<GLint, 4> {offset[0], offset[1], size[0], size[1]});
+  }
+  // The value is copied and later set through program::set_uniform, hence the type has to be trivially copyable and supported
+  // by the type-inferring setters.
+  template <typename type>
+  void set_uniform          (program& program, const GLint location, const type& value)
+  {
+    static_assert(std::is_trivially_copyable_v<type>, "Uniform values must be trivially copyable.");
+    static_assert(alignof(type) <= alignment        , "Uniform values may not be over-aligned.");
+
+    const auto offset = push_extra<uniform_command>(sizeof(type), command_type::set_uniform, &program, location, &set_uniform_function<type>);
+    std::memcpy(data_.data() + offset + aligned_size(sizeof(uniform_command)), &value, sizeof(type));
+  }
+
+  // Draws and dispatches.
+  void draw_arrays                                      (const GLenum mode, const GLint offset, const GLsizei count)
+  {
+    draw_arrays_instanced_base_instance(mode, offset, count, 1, 0);
+  }
+  void draw_arrays_instanced                            (const GLenum mode, const GLint offset, const GLsizei count, const GLsizei instance_count = 1)
+  {
+    draw_arrays_instanced_base_instance(mode, offset, count, instance_count, 0);
+  }
+  void draw_arrays_instanced_base_instance              (const GLenum mode, const GLint offset, const GLsizei count, const GLsizei instance_count = 1, const GLuint base_instance = 0)
+  {
+    push<draw_command>(command_type::draw_arrays, mode, GLenum(0), static_cast<GLintptr>(offset), count, instance_count, 0, base_instance);
+  }
+  void draw_arrays_indirect                             (const GLenum mode, const GLint offset = 0)
+  {
+    multi_draw_arrays_indirect(mode, offset, 1, 0);
+  }
+  void multi_draw_arrays_indirect                       (const GLenum mode, const GLint offset, const GLsizei draw_count, const GLsizei stride = sizeof(draw_arrays_indirect_command))
+  {
+    push<draw_command>(command_type::multi_draw_arrays_indirect, mode, GLenum(0), static_cast<GLintptr>(offset), draw_count, stride, 0, 0u);
+  }
+  void draw_elements                                    (const GLenum mode, const GLsizei count, const GLenum type, const void* indices = nullptr)
+  {
+    draw_elements_instanced_base_vertex_base_instance(mode, count, type, indices, 1, 0, 0);
+  }
+  void draw_elements_instanced                          (const GLenum mode, const GLsizei count, const GLenum type, const void* indices = nullptr, const GLsizei instance_count = 1)
+  {
+    draw_elements_instanced_base_vertex_base_instance(mode, count, type, indices, instance_count, 0, 0);
+  }
+  void draw_elements_base_vertex                        (const GLenum mode, const GLsizei count, const GLenum type, const void* indices = nullptr, const GLint base_vertex = 0)
+  {
+    draw_elements_instanced_base_vertex_base_instance(mode, count, type, indices, 1, base_vertex, 0);
+  }
+  void draw_elements_instanced_base_vertex_base_instance(const GLenum mode, const GLsizei count, const GLenum type, const void* indices = nullptr, const GLsizei instance_count = 1, const GLint base_vertex = 0, const GLuint base_instance = 0)
+  {
+    push<draw_command>(command_type::draw_elements, mode, type, reinterpret_cast<GLintptr>(indices), count, instance_count, base_vertex, base_instance);
+  }
+  void draw_elements_indirect                           (const GLenum mode, const GLenum type, const GLint offset = 0)
+  {
+    multi_draw_elements_indirect(mode, type, offset, 1, 0);
+  }
+  void multi_draw_elements_indirect                     (const GLenum mode, const GLenum type, const GLint offset, const GLsizei draw_count, const GLsizei stride = sizeof(draw_elements_indirect_command))
+  {
+    push<draw_command>(command_type::multi_draw_elements_indirect, mode, type, static_cast<GLintptr>(offset), draw_count, stride, 0, 0u);
+  }
+  void dispatch_compute                                 (const GLuint grid_x, const GLuint grid_y, const GLuint grid_z)
+  {
+    push<value_command<std::array<GLuint, 3>>>(command_type::dispatch_compute, std::array<GLuint, 3> {grid_x, grid_y, grid_z});
+  }
+  void dispatch_compute_indirect                        (const GLintptr offset)
+  {
+    push<value_command<GLintptr>>(command_type::dispatch_compute_indirect, offset);
+  }
+
+  // Barriers.
+  void memory_barrier          (const GLbitfield barrier_bits = GL_ALL_BARRIER_BITS)
+  {
+    push<value_command<GLbitfield>>(command_type::memory_barrier, barrier_bits);
+  }
+  void memory_barrier_by_region(const GLbitfield barrier_bits = GL_ALL_BARRIER_BITS)
+  {
+    push<value_command<GLbitfield>>(command_type::memory_barrier_by_region, barrier_bits);
+  }
+  void texture_barrier         ()
+  {
+    push<header>(command_type::texture_barrier);
+  }
+
+  // Clears.
+  void set_clear_color  (const std::array<GLfloat, 4>& color)
+  {
+    push<value_command<std::array<GLfloat, 4>>>(command_type::set_clear_color, color);
+  }
+  void set_clear_depth  (const GLdouble   depth  )
+  {
+    push<value_command<GLdouble>>(command_type::set_clear_depth, depth);
+  }
+  void set_clear_stencil(const GLint      stencil)
+  {
+    push<value_command<GLint>>(command_type::set_clear_stencil, stencil);
+  }
+  void clear            (const GLbitfield buffer_bits = GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT)
+  {
+    push<value_command<GLbitfield>>(command_type::clear, buffer_bits);
+  }
+
+  // Executes the commands with the cache made current for the duration, restoring the previously current one afterwards.
+  void execute(state_cache& cache) const
+  {
+    auto* previous = state_cache::current();
+    cache.make_current();
+    execute();
+    state_cache::set_current(previous);
+  }
+  // Executes the commands with the cache current on the calling thread, if any.
+  void execute() const
+  {
+    for (std::size_t offset = 0; offset < data_.size();)
+    {
+      const auto* command = data_.data() + offset;
+      const auto& head    = as<header>(command);
+      switch (head.type)
+      {
+      case command_type::use_program:
+        as<object_command<program_type>>(command).object->use();
+        break;
+      case command_type::bind_vertex_array:
+        as<object_command<gl::vertex_array>>(command).object->bind();
+        break;
+      case command_type::bind_framebuffer:
+      {
+        const auto& value = as<framebuffer_command>(command);
+        value.object != nullptr ? value.object->bind(value.target) : framebuffer::unbind(value.target);
+        break;
+      }
+      case command_type::bind_buffer:
+      {
+        const auto& value = as<buffer_command>(command);
+        value.object->bind(value.target);
+        break;
+      }
+      case command_type::bind_buffer_base:
+      {
+        const auto& value = as<buffer_command>(command);
+        value.object->bind_base(value.target, value.index);
+        break;
+      }
+      case command_type::bind_buffer_range:
+      {
+        const auto& value = as<buffer_command>(command);
+        value.object->bind_range(value.target, value.index, value.offset, value.size);
+        break;
+      }
+      case command_type::bind_textures:
+        gl::bind_textures      (as<range_command>(command).first, array<texture_ref>(command));
+        break;
+      case command_type::bind_image_textures:
+        gl::bind_image_textures(as<range_command>(command).first, array<texture_ref>(command));
+        break;
+      case command_type::bind_samplers:
+        gl::bind_samplers      (as<range_command>(command).first, array<sampler_ref>(command));
+        break;
+      case command_type::bind_buffers_range:
+      {
+        const auto& value = as<range_command>(command);
+        gl::bind_buffers_range(value.target, value.first, array<buffer_range>(command));
+        break;
+      }
+      case command_type::apply_render_state:
+        render_state::apply(as<value_command<render_state>>(command).value);
+        break;
+      case command_type::set_viewport:
+      {
+        const auto& value = as<value_command<std::array<GLint, 4>>>(command).value;
+        gl::set_viewport({value[0], value[1]}, {value[2], value[3]});
+        break;
+      }
+      case command_type::set_uniform:
+      {
+        const auto& value = as<uniform_command>(command);
+        value.function(*value.program, value.location, command + aligned_size(sizeof(uniform_command)));
+        break;
+      }
+      case command_type::draw_arrays:
+      {
+        const auto& value = as<draw_command>(command);
+        gl::draw_arrays_instanced_base_instance(value.mode, static_cast<GLint>(value.offset), value.count, value.instance_count, value.base_instance);
+        break;
+      }
+      case command_type::multi_draw_arrays_indirect:
+      {
+        const auto& value = as<draw_command>(command);
+        gl::multi_draw_arrays_indirect(value.mode, static_cast<GLint>(value.offset), value.count, value.instance_count);
+        break;
+      }
+      case command_type::draw_elements:
+      {
+        const auto& value = as<draw_command>(command);
+        gl::draw_elements_instanced_base_vertex_base_instance(value.mode, value.count, value.type, reinterpret_cast<const void*>(value.offset), value.instance_count, value.base_vertex, value.base_instance);
+        break;
+      }
+      case command_type::multi_draw_elements_indirect:
+      {
+        const auto& value = as<draw_command>(command);
+        gl::multi_draw_elements_indirect(value.mode, value.type, static_cast<GLint>(value.offset), value.count, value.instance_count);
+        break;
+      }
+      case command_type::dispatch_compute:
+      {
+        const auto& value = as<value_command<std::array<GLuint, 3>>>(command).value;
+        gl::dispatch_compute(value[0], value[1], value[2]);
+        break;
+      }
+      case command_type::dispatch_compute_indirect:
+        gl::dispatch_compute_indirect(as<value_command<GLintptr>>(command).value);
+        break;
+      case command_type::memory_barrier:
+        gl::memory_barrier(as<value_command<GLbitfield>>(command).value);
+        break;
+      case command_type::memory_barrier_by_region:
+        gl::memory_barrier_by_region(as<value_command<GLbitfield>>(command).value);
+        break;
+      case command_type::texture_barrier:
+        gl::texture_barrier();
+        break;
+      case command_type::set_clear_color:
+        gl::set_clear_color(as<value_command<std::array<GLfloat, 4>>>(command).value);
+        break;
+      case command_type::set_clear_depth:
+        gl::set_clear_depth(as<value_command<GLdouble>>(command).value);
+        break;
+      case command_type::set_clear_stencil:
+        gl::set_clear_stencil(as<value_command<GLint>>(command).value);
+        break;
+      case command_type::clear:
+        gl::clear(as<value_command<GLbitfield>>(command).value);
+        break;
+      }
+      offset += head.size;
+    }
+  }
+
+  // Appends the commands of another list.
+  void append(const command_list& that)
+  {
+    data_.insert(data_.end(), that.data_.begin(), that.data_.end());
+    size_ += that.size_;
+  }
+  // Empties the list; distinct from clear(buffer_bits), which records a clear command.
+  void reset ()
+  {
+    data_.clear();
+    size_ = 0;
+  }
+
+  [[nodiscard]]
+  std::size_t size       () const
+  {
+    return size_;
+  }
+  [[nodiscard]]
+  bool        empty      () const
+  {
+    return size_ == 0;
+  }
+  // In bytes.
+  [[nodiscard]]
+  std::size_t arena_size () const
+  {
+    return data_.size();
+  }
+  void        reserve    (const std::size_t bytes)
+  {
+    data_.reserve(bytes);
+  }
+
+protected:
+  using program_type = gl::program;
+
+  enum class command_type : std::uint32_t
+  {
+    use_program,
+    bind_vertex_array,
+    bind_framebuffer,
+    bind_buffer,
+    bind_buffer_base,
+    bind_buffer_range,
+    bind_textures,
+    bind_image_textures,
+    bind_samplers,
+    bind_buffers_range,
+    apply_render_state,
+    set_viewport,
+    set_uniform,
+    draw_arrays,
+    multi_draw_arrays_indirect,
+    draw_elements,
+    multi_draw_elements_indirect,
+    dispatch_compute,
+    dispatch_compute_indirect,
+    memory_barrier,
+    memory_barrier_by_region,
+    texture_barrier,
+    set_clear_color,
+    set_clear_depth,
+    set_clear_stencil,
+    clear
+  };
+
+  // Every command starts at a multiple of the alignment and begins with a header holding its size including trailing data.
+  static constexpr std::size_t alignment = 8;
+
+  struct header
+  {
+    command_type  type;
+    std::uint32_t size;
+  };
+  template <typename object_type>
+  struct object_command      : header
+  {
+    const object_type* object;
+  };
+  struct framebuffer_command : header
+  {
+    const framebuffer* object;
+    GLenum             target;
+  };
+  struct buffer_command      : header
+  {
+    const buffer* object;
+    GLenum        target;
+    GLuint        index ;
+    GLintptr      offset;
+    GLsizeiptr    size  ;
+  };
+  // Followed by count elements.
+  struct range_command       : header
+  {
+    GLuint      first ;
+    GLenum      target;
+    std::size_t count ;
+  };
+  template <typename value_type>
+  struct value_command       : header
+  {
+    value_type value;
+  };
+  // Followed by the value.
+  struct uniform_command     : header
+  {
+    program_type* program ;
+    GLint         location;
+    void        (*function)(program_type&, GLint, const void*);
+  };
+  // Indirect draws store the draw count in count and the stride in instance_count.
+  struct draw_command        : header
+  {
+    GLenum   mode          ;
+    GLenum   type          ;
+    GLintptr offset        ;
+    GLsizei  count         ;
+    GLsizei  instance_count;
+    GLint    base_vertex   ;
+    GLuint   base_instance ;
+  };
+
+  static constexpr std::size_t aligned_size(const std::size_t size)
+  {
+    return (size + alignment - 1) / alignment * alignment;
+  }
+
+  template <typename type>
+  static const type& as(const std::uint8_t* command)
+  {
+    return *std::launder(reinterpret_cast<const type*>(command));
+  }
+  template <typename type>
+  static span<const type> array(const std::uint8_t* command)
+  {
+    const auto& value = as<range_command>(command);
+    return span<const type>(std::launder(reinterpret_cast<const type*>(command + aligned_size(sizeof(range_command)))), value.count);
+  }
+  template <typename type>
+  static void set_uniform_function(program_type& program, const GLint location, const void* data)
+  {
+    type value;
+    std::memcpy(&value, data, sizeof(type));
+    program.set_uniform(location, value);
+  }
+
+  // Returns the offset of the command in the arena.
+  template <typename command, typename... arguments>
+  std::size_t push      (const command_type type, arguments&&... values)
+  {
+    return push_extra<command>(0, type, std::forward<arguments>(values)...);
+  }
+  template <typename command, typename... arguments>
+  std::size_t push_extra(const std::size_t extra, const command_type type, arguments&&... values)
+  {
+    static_assert(std::is_trivially_copyable_v<command> && alignof(command) <= alignment, "Commands must be trivially copyable and not over-aligned.");
+
+    const auto offset = data_.size();
+    const auto size   = aligned_size(sizeof(command)) + aligned_size(extra);
+    data_.resize(offset + size);
+    new (data_.data() + offset) command {header {type, static_cast<std::uint32_t>(size)}, std::forward<arguments>(values)...};
+    ++size_;
+    return offset;
+  }
+  template <typename command, typename type, typename... arguments>
+  void        push_array(const command_type command_type, const span<const type> elements, arguments&&... values)
+  {
+    static_assert(std::is_trivially_copyable_v<type> && alignof(type) <= alignment, "Elements must be trivially copyable and not over-aligned.");
+
+    const auto offset = push_extra<command>(sizeof(type) * elements.size(), command_type, std::forward<arguments>(values)..., elements.size());
+    if (!elements.empty())
+      std::memcpy(data_.data() + offset + aligned_size(sizeof(command)), elements.data(), sizeof(type) * elements.size());
+  }
+
+  std::vector<std::uint8_t> data_;
+  std::size_t               size_ = 0;
+};
+}
+
+#endif
@@ -0,0 +1,276 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_AUXILIARY_COROUTINES_HPP
+#define GL_AUXILIARY_COROUTINES_HPP
+
+// Requires C++20 coroutines; empty otherwise.
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <utility>
+#include <vector>
+
+#include <gl/opengl.hpp>
+#include <gl/buffer.hpp>
+#include <gl/program.hpp>
+#include <gl/query.hpp>
+#include <gl/shader.hpp>
+#include <gl/sync.hpp>
+
+namespace gl
+{
+// Resumes coroutines waiting on GL operations. tick() polls every pending operation once with non-blocking calls (zero timeouts,
+// availability and completion status queries) and resumes those which are ready, hence no thread ever blocks on the driver.
+// There is one scheduler per thread; call tick() on the GL thread, e.g. once per frame. Coroutines resume inside tick().
+class scheduler
+{
+public:
+  scheduler           ()                       = default;
+  scheduler           (const scheduler&  that) = delete;
+  scheduler           (      scheduler&& temp) = delete;
+  virtual ~scheduler  ()                       = default;
+  scheduler& operator=(const scheduler&  that) = delete;
+  scheduler& operator=(      scheduler&& temp) = delete;
+
+  // The scheduler of the calling thread, to which awaitables on this thread are registered.
+  static scheduler& current()
+  {
+    static thread_local scheduler instance;
+    return instance;
+  }
+
+  void        schedule(bool (*poll)(void*), void* operation, const std::coroutine_handle<> handle)
+  {
+    pending_.push_back(entry {poll, operation, handle});
+  }
+  // Returns the number of coroutines resumed.
+  std::size_t tick    ()
+  {
+    ready_.clear();
+    auto kept = pending_.begin();
+    for (auto iterator = pending_.begin(); iterator != pending_.end(); ++iterator)
+    {
+      if (iterator->poll(iterator->operation))
+        ready_.push_back(iterator->handle);
+      else
+        *kept++ = *iterator;
+    }
+    pending_.erase(kept, pending_.end());
+
+    // Resumed coroutines may schedule again, which only appends to pending_.
+    auto ready = std::move(ready_);
+    for (const auto handle : ready)
+      handle.resume();
+    ready_ = std::move(ready);
+    return ready_.size();
+  }
+
+  [[nodiscard]]
+  std::size_t pending () const
+  {
+    return pending_.size();
+  }
+
+protected:
+  struct entry
+  {
+    bool                  (*poll)(void*);
+    void*                   operation;
+    std::coroutine_handle<> handle   ;
+  };
+
+  std::vector<entry>                   pending_;
+  std::vector<std::coroutine_handle<>> ready_  ;
+};
+
+// The base of the awaitables: derived types provide bool poll() and await_resume().
+template<typename derived>
+struct awaitable
+{
+  bool await_ready  ()
+  {
+    return static_cast<derived*>(this)->poll();
+  }
+  void await_suspend(const std::coroutine_handle<> handle)
+  {
+    scheduler::current().schedule([ ] (void* operation) { return static_cast<derived*>(operation)->poll(); }, static_cast<derived*>(this), handle);
+  }
+};
+
+// Awaits a fence. The first poll flushes, so that the fence is guaranteed to signal.
+struct sync_awaitable : awaitable<sync_awaitable>
+{
+  explicit sync_awaitable(const sync& fence) : fence(fence)
+  {
+
+  }
+
+  bool poll        ()
+  {
+    const auto status = fence.client_wait(flushed ? 0 : GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    flushed = true;
+    return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED || status == GL_WAIT_FAILED;
+  }
+  void await_resume() const
+  {
+
+  }
+
+  const sync& fence  ;
+  bool        flushed = false;
+};
+// Awaits the result of a query, which it returns.
+template<GLenum target>
+struct query_awaitable : awaitable<query_awaitable<target>>
+{
+  explicit query_awaitable(const query<target>& value) : value(value)
+  {
+
+  }
+
+  bool     poll        () const
+  {
+    return value.available();
+  }
+  GLuint64 await_resume() const
+  {
+    return value.result_no_wait();
+  }
+
+  const query<target>& value;
+};
+// Awaits a link started with program::begin_link() and completes it, returning the link status.
+struct link_awaitable : awaitable<link_awaitable>
+{
+  explicit link_awaitable(const program& value) : value(value)
+  {
+
+  }
+
+  bool poll        () const
+  {
+    return value.completion_status();
+  }
+  bool await_resume() const
+  {
+    return value.end_link();
+  }
+
+  const program& value;
+};
+// Awaits a compilation started with shader::begin_compile(), returning the compile status.
+struct compile_awaitable : awaitable<compile_awaitable>
+{
+  explicit compile_awaitable(const shader& value) : value(value)
+  {
+
+  }
+
+  bool poll        () const
+  {
+    return value.completion_status();
+  }
+  bool await_resume() const
+  {
+    return value.compile_status();
+  }
+
+  const shader& value;
+};
+// Copies a range of a buffer into a staging buffer and fences the copy on construction; returns the data once the copy is done.
+struct readback_awaitable : awaitable<readback_awaitable>
+{
+  readback_awaitable(const buffer& source, const GLintptr offset, const GLsizeiptr size) : size(size), staging(copy(source, offset, size))
+  {
+
+  }
+
+  bool                 poll        ()
+  {
+    const auto status = fence.client_wait(flushed ? 0 : GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    flushed = true;
+    return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED || status == GL_WAIT_FAILED;
+  }
+  std::vector<GLubyte> await_resume() const
+  {
+    return staging.sub_data(0, size);
+  }
+
+  static buffer copy(const buffer& source, const GLintptr offset, const GLsizeiptr size)
+  {
+    buffer result;
+    result.set_data_immutable(size, nullptr, 0);
+    result.copy_sub_data(source, offset, 0, size);
+    return result;
+  }
+
+  GLsizeiptr size   ;
+  buffer     staging;
+  sync       fence  ; // Constructed after the copy is issued.
+  bool       flushed = false;
+};
+
+inline sync_awaitable     when_signaled (const sync&    fence )
+{
+  return sync_awaitable(fence);
+}
+template<GLenum target>
+query_awaitable<target>   when_available(const query<target>& value)
+{
+  return query_awaitable<target>(value);
+}
+// Starts linking the program and returns an awaitable which completes it. The shaders must be attached (and compiled).
+inline link_awaitable     linked        (const program& value )
+{
+  value.begin_link();
+  return link_awaitable(value);
+}
+// Starts compiling the shader and returns an awaitable which yields the compile status.
+inline compile_awaitable  compiled      (const shader&  value )
+{
+  value.begin_compile();
+  return compile_awaitable(value);
+}
+inline readback_awaitable read_back     (const buffer&  source, const GLintptr offset, const GLsizeiptr size)
+{
+  return readback_awaitable(source, offset, size);
+}
+
+// A fire-and-forget coroutine: it starts immediately, runs until its first co_await on a GL operation and is resumed by the
+// scheduler of its thread. Its frame is destroyed when it completes. Exceptions terminate.
+struct task
+{
+  struct promise_type
+  {
+    task                get_return_object  ()
+    {
+      return task();
+    }
+    std::suspend_never  initial_suspend    () noexcept
+    {
+      return {};
+    }
+    std::suspend_never  final_suspend      () noexcept
+    {
+      return {};
+    }
+    void                return_void        ()
+    {
+
+    }
+    void                unhandled_exception()
+    {
+      std::terminate();
+    }
+  };
+};
+}
+
+#endif
+
+#endif
@@ -0,0 +1,300 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_AUXILIARY_DEBUG_MESSAGE_RING_HPP
+#define GL_AUXILIARY_DEBUG_MESSAGE_RING_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+
+#include <gl/opengl.hpp>
+
+namespace gl
+{
+// A debug message copied into fixed storage. Messages longer than message_capacity - 1 characters are truncated.
+struct debug_record
+{
+  static constexpr std::size_t message_capacity = 256;
+
+  [[nodiscard]]
+  std::string_view message_view() const
+  {
+    return std::string_view(message, length);
+  }
+
+  GLenum        source    = 0;
+  GLenum        type      = 0;
+  GLuint        id        = 0;
+  GLenum        severity  = 0;
+  std::uint32_t length    = 0;
+  bool          truncated = false;
+  char          message[message_capacity] {};
+};
+
+struct debug_message_statistics
+{
+  std::size_t received       = 0; // Messages passed to the callback.
+  std::size_t enqueued       = 0;
+  std::size_t rate_limited   = 0; // Duplicates of a message beyond the rate limit within a drain.
+  std::size_t overflowed     = 0; // Messages dropped as the ring was full.
+  std::size_t suppressed_ids = 0; // Messages (source, type and id) disabled through glDebugMessageControl.
+};
+struct debug_message_counts
+{
+  std::size_t count        = 0; // Messages received with the source, type and id.
+  std::size_t rate_limited = 0;
+  bool        suppressed   = false;
+};
+
+// Collects debug output into a bounded lock-free ring of debug_records, which the callback fills without allocating or locking,
+// from any number of driver threads, and a single consumer drains on its own thread. Messages are identified by their source,
+// type and id, as ids are only unique within a source and type. Per message, at most rate_limit messages are enqueued between
+// drains and the rest are only counted; once a message has been received suppression_threshold times, it is disabled at the
+// source through glDebugMessageControl by the next apply_suppressions(), which must be called on the thread of the context (the
+// callback may not call GL). Messages are tracked in a fixed table of id_capacity entries; messages beyond are neither rate
+// limited nor suppressed. The ring registers itself as user data of the callback, hence it may not be moved.
+template<std::size_t capacity = 1024, std::size_t id_capacity = 512>
+class debug_message_ring
+{
+public:
+  static_assert(capacity    > 0 && (capacity    & (capacity    - 1)) == 0, "The capacity must be a power of two.");
+  static_assert(id_capacity > 0 && (id_capacity & (id_capacity - 1)) == 0, "The id capacity must be a power of two.");
+
+  explicit debug_message_ring  (const std::uint32_t rate_limit = 8, const std::uint32_t suppression_threshold = 1024)
+  : cells_(std::make_unique<std::array<cell, capacity>>()), ids_(std::make_unique<std::array<id_entry, id_capacity>>()), rate_limit_(rate_limit), suppression_threshold_(suppression_threshold)
+  {
+    for (std::size_t i = 0; i < capacity; ++i)
+      (*cells_)[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  debug_message_ring           (const debug_message_ring&  that) = delete;
+  debug_message_ring           (      debug_message_ring&& temp) = delete;
+  virtual ~debug_message_ring  ()
+  {
+    if (installed_)
+      uninstall();
+  }
+  debug_message_ring& operator=(const debug_message_ring&  that) = delete;
+  debug_message_ring& operator=(      debug_message_ring&& temp) = delete;
+
+  // Sets the ring as the debug message callback of the current context.
+  void install  ()
+  {
+    glDebugMessageCallback(static_cast<GLDEBUGPROC>([ ] (const GLenum source, const GLenum type, const GLuint id, const GLenum severity, const GLsizei length, const GLchar* message, const void* data)
+    {
+      static_cast<debug_message_ring*>(const_cast<void*>(data))->push(source, type, id, severity, length, message);
+    }), this);
+    installed_ = true;
+  }
+  void uninstall()
+  {
+    glDebugMessageCallback(nullptr, nullptr);
+    installed_ = false;
+  }
+
+  // Enqueues a message; safe to call concurrently. Returns false if the message was rate limited or the ring was full.
+  bool push(const GLenum source, const GLenum type, const GLuint id, const GLenum severity, const GLsizei length, const GLchar* message)
+  {
+    received_.fetch_add(1, std::memory_order_relaxed);
+
+    if (auto* entry = find(source, type, id, true))
+    {
+      const auto count = entry->count.fetch_add(1, std::memory_order_relaxed) + 1;
+      if (suppression_threshold_ > 0 && count == suppression_threshold_)
+        entry->state.store(id_state::pending, std::memory_order_release);
+      if (entry->window.fetch_add(1, std::memory_order_relaxed) >= rate_limit_)
+      {
+        entry->rate_limited.fetch_add(1, std::memory_order_relaxed);
+        rate_limited_      .fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+    }
+
+    auto position = enqueue_.load(std::memory_order_relaxed);
+    cell* target;
+    while (true)
+    {
+      target = &(*cells_)[position & (capacity - 1)];
+      const auto sequence   = target->sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+      if      (difference == 0)
+      {
+        if (enqueue_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (difference <  0)
+      {
+        overflowed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      else
+        position = enqueue_.load(std::memory_order_relaxed);
+    }
+
+    auto& record    = target->record;
+    const auto size = static_cast<std::size_t>(length >= 0 ? length : static_cast<GLsizei>(std::strlen(message)));
+    record.source    = source;
+    record.type      = type;
+    record.id        = id;
+    record.severity  = severity;
+    record.length    = static_cast<std::uint32_t>(std::min(size, debug_record::message_capacity - 1));
+    record.truncated = size > record.length;
+    std::memcpy(record.message, message, record.length);
+    record.message[record.length] = '\0';
+    target->sequence.store(position + 1, std::memory_order_release);
+
+    enqueued_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  // Calls function(const debug_record&) for each enqueued record in order, and restarts the rate limiting window of every message.
+  // Only one thread may drain at a time. Returns the number of records drained.
+  template<typename function_type>
+  std::size_t drain(function_type&& function)
+  {
+    std::size_t result = 0;
+    while (true)
+    {
+      auto&      target   = (*cells_)[dequeue_ & (capacity - 1)];
+      const auto sequence = target.sequence.load(std::memory_order_acquire);
+      if (sequence != dequeue_ + 1)
+        break;
+      function(static_cast<const debug_record&>(target.record));
+      target.sequence.store(dequeue_ + capacity, std::memory_order_release);
+      ++dequeue_;
+      ++result;
+    }
+
+    for (auto& entry : *ids_)
+      if (entry.key.load(std::memory_order_relaxed) != 0)
+        entry.window.store(0, std::memory_order_relaxed);
+    return result;
+  }
+  // Disables the messages which crossed the suppression threshold. Call on the thread of the context, e.g. once per frame.
+  std::size_t apply_suppressions()
+  {
+    std::size_t result = 0;
+    for (auto& entry : *ids_)
+    {
+      auto expected = id_state::pending;
+      if (!entry.state.compare_exchange_strong(expected, id_state::suppressed, std::memory_order_acquire))
+        continue;
+      const auto key = entry.key.load(std::memory_order_relaxed) - 1;
+      const auto id  = static_cast<GLuint>(key & 0xFFFFFFFF);
+      glDebugMessageControl(static_cast<GLenum>(key >> 48), static_cast<GLenum>((key >> 32) & 0xFFFF), GL_DONT_CARE, 1, &id, GL_FALSE);
+      ++result;
+    }
+    suppressed_ids_ += result;
+    return result;
+  }
+
+  [[nodiscard]]
+  debug_message_statistics statistics() const
+  {
+    debug_message_statistics result;
+    result.received       = received_    .load(std::memory_order_relaxed);
+    result.enqueued       = enqueued_    .load(std::memory_order_relaxed);
+    result.rate_limited   = rate_limited_.load(std::memory_order_relaxed);
+    result.overflowed     = overflowed_  .load(std::memory_order_relaxed);
+    result.suppressed_ids = suppressed_ids_;
+    return result;
+  }
+  [[nodiscard]]
+  debug_message_counts     counts    (const GLenum source, const GLenum type, const GLuint id) const
+  {
+    debug_message_counts result;
+    if (const auto* entry = const_cast<debug_message_ring*>(this)->find(source, type, id, false))
+    {
+      result.count        = entry->count       .load(std::memory_order_relaxed);
+      result.rate_limited = entry->rate_limited.load(std::memory_order_relaxed);
+      result.suppressed   = entry->state       .load(std::memory_order_relaxed) == id_state::suppressed;
+    }
+    return result;
+  }
+
+  // The limits are read by the callback unsynchronized; set them before install().
+  void          set_rate_limit           (const std::uint32_t rate_limit)
+  {
+    rate_limit_ = rate_limit;
+  }
+  [[nodiscard]]
+  std::uint32_t rate_limit               () const
+  {
+    return rate_limit_;
+  }
+  void          set_suppression_threshold(const std::uint32_t suppression_threshold)
+  {
+    suppression_threshold_ = suppression_threshold;
+  }
+  [[nodiscard]]
+  std::uint32_t suppression_threshold    () const
+  {
+    return suppression_threshold_;
+  }
+
+protected:
+  enum class id_state : std::uint8_t
+  {
+    active     = 0,
+    pending    = 1, // Crossed the threshold, awaiting apply_suppressions().
+    suppressed = 2
+  };
+
+  struct cell
+  {
+    std::atomic<std::size_t> sequence {0};
+    debug_record             record   ;
+  };
+  struct id_entry
+  {
+    std::atomic<std::uint64_t> key          {0}; // The source, type and id packed into 16, 16 and 32 bits, + 1; 0 if the entry is free.
+    std::atomic<std::uint32_t> count        {0};
+    std::atomic<std::uint32_t> window       {0}; // Messages since the last drain.
+    std::atomic<std::uint32_t> rate_limited {0};
+    std::atomic<id_state>      state        {id_state::active};
+  };
+
+  // Open addressing with linear probing; entries are claimed with a compare exchange and never released.
+  // GL enumerants fit in 16 bits, hence the packed key is unique per source, type and id.
+  id_entry* find(const GLenum source, const GLenum type, const GLuint id, const bool insert)
+  {
+    const auto key   = ((static_cast<std::uint64_t>(source & 0xFFFF) << 48) | (static_cast<std::uint64_t>(type & 0xFFFF) << 32) | id) + 1;
+    const auto start = static_cast<std::size_t>((key * 11400714819323198485ull) >> 32) & (id_capacity - 1);
+    for (std::size_t i = 0, index = start; i < id_capacity; ++i, index = (index + 1) & (id_capacity - 1))
+    {
+      auto& entry   = (*ids_)[index];
+      auto  current = entry.key.load(std::memory_order_acquire);
+      if (current == key)
+        return &entry;
+      if (current != 0)
+        continue;
+      if (!insert)
+        return nullptr;
+      if (entry.key.compare_exchange_strong(current, key, std::memory_order_acq_rel) || current == key)
+        return &entry;
+    }
+    return nullptr;
+  }
+
+  std::unique_ptr<std::array<cell, capacity>>        cells_                ;
+  std::unique_ptr<std::array<id_entry, id_capacity>> ids_                  ;
+  std::uint32_t                                      rate_limit_           ;
+  std::uint32_t                                      suppression_threshold_;
+  std::atomic<std::size_t>                           enqueue_              {0};
+  std::size_t                                        dequeue_              = 0;
+  std::atomic<std::size_t>                           received_             {0};
+  std::atomic<std::size_t>                           enqueued_             {0};
+  std::atomic<std::size_t>                           rate_limited_         {0};
+  std::atomic<std::size_t>                           overflowed_           {0};
+  std::size_t                                        suppressed_ids_       = 0;
+  bool                                               installed_            = false;
+};
+}
+
+#endif
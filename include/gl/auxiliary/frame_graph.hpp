@@ -0,0 +1,464 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_AUXILIARY_FRAME_GRAPH_HPP
+#define GL_AUXILIARY_FRAME_GRAPH_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gl/opengl.hpp>
+#include <gl/framebuffer.hpp>
+#include <gl/renderbuffer.hpp>
+#include <gl/texture.hpp>
+
+namespace gl
+{
+using frame_graph_resource = std::size_t;
+using frame_graph_pass     = std::size_t;
+
+// Transient resources with equal descriptions are compatible, i.e. may share a physical object when their lifetimes do not overlap.
+struct frame_graph_description
+{
+  enum class kind_type
+  {
+    texture_2d  ,
+    renderbuffer
+  };
+
+  bool operator==(const frame_graph_description& that) const
+  {
+    return kind == that.kind && internal_format == that.internal_format && width == that.width && height == that.height && levels == that.levels && samples == that.samples;
+  }
+  bool operator!=(const frame_graph_description& that) const
+  {
+    return !(*this == that);
+  }
+
+  kind_type kind            = kind_type::texture_2d;
+  GLenum    internal_format = GL_RGBA8;
+  GLsizei   width           = 1;
+  GLsizei   height          = 1;
+  GLsizei   levels          = 1; // Textures only.
+  GLsizei   samples         = 0; // Renderbuffers only; 0 is single sampled.
+};
+
+struct frame_graph_statistics
+{
+  std::size_t passes           = 0;
+  std::size_t culled_passes    = 0;
+  std::size_t transients       = 0; // Transient resources used by the passes kept.
+  std::size_t physical_objects = 0; // Physical objects they were aliased onto.
+  std::size_t transient_bytes  = 0; // Without aliasing, i.e. one object per transient.
+  std::size_t physical_bytes   = 0;
+  std::size_t invalidations    = 0; // Of the last execute().
+
+  [[nodiscard]]
+  double saved_ratio() const // Fraction of transient memory saved by aliasing.
+  {
+    return transient_bytes > 0 ? 1.0 - static_cast<double>(physical_bytes) / static_cast<double>(transient_bytes) : 0.0;
+  }
+};
+
+// Schedules the passes of a frame. Passes declare the resources they read and write; compile() culls the passes which contribute
+// to neither an imported resource, an output nor a side effect, computes the lifetime of each transient resource over the passes
+// kept, and aliases transients with equal descriptions and disjoint lifetimes onto the same physical textures and renderbuffers.
+// execute() runs the passes in declaration order and invalidates each transient after its last use: through the framebuffer of
+// the pass if the resource was declared with an attachment there (so that tiled GPUs need not store it), or directly otherwise.
+// Transients marked as outputs are neither invalidated nor aliased with later transients, as they are read after execute().
+// The contents of a transient are undefined before its first write. Physical objects persist across frames; rebuild the graph
+// each frame with reset(), which keeps them, and release those left unused by the last compile() with trim().
+class frame_graph
+{
+public:
+  using execute_function = std::function<void(const frame_graph&)>;
+
+  frame_graph           ()                         = default;
+  frame_graph           (const frame_graph&  that) = delete;
+  frame_graph           (      frame_graph&& temp) = default;
+  virtual ~frame_graph  ()                         = default;
+  frame_graph& operator=(const frame_graph&  that) = delete;
+  frame_graph& operator=(      frame_graph&& temp) = default;
+
+  // Resources.
+  frame_graph_resource create_transient   (const std::string& name, const frame_graph_description& description)
+  {
+    resource_node value;
+    value.name        = name;
+    value.description = description;
+    resources_.push_back(std::move(value));
+    return resources_.size() - 1;
+  }
+  frame_graph_resource import_texture     (const std::string& name, const texture_2d&   texture     )
+  {
+    resource_node value;
+    value.name             = name;
+    value.imported_texture = &texture;
+    value.output           = true;
+    resources_.push_back(std::move(value));
+    return resources_.size() - 1;
+  }
+  frame_graph_resource import_renderbuffer(const std::string& name, const gl::renderbuffer& renderbuffer)
+  {
+    resource_node value;
+    value.name                  = name;
+    value.description.kind      = frame_graph_description::kind_type::renderbuffer;
+    value.imported_renderbuffer = &renderbuffer;
+    value.output                = true;
+    resources_.push_back(std::move(value));
+    return resources_.size() - 1;
+  }
+  // Keeps the passes writing a transient which is consumed outside the graph, e.g. read back after execute().
+  void                 mark_output        (const frame_graph_resource resource)
+  {
+    resources_[resource].output = true;
+  }
+
+  // Passes.
+  frame_graph_pass add_pass        (const std::string& name, execute_function function, const bool side_effects = false)
+  {
+    pass_node value;
+    value.name         = name;
+    value.function     = std::move(function);
+    value.side_effects = side_effects;
+    passes_.push_back(std::move(value));
+    return passes_.size() - 1;
+  }
+  // The attachment (e.g. GL_COLOR_ATTACHMENT0) the resource is attached to in the framebuffer of the pass, or GL_NONE.
+  void             read            (const frame_graph_pass pass, const frame_graph_resource resource, const GLenum attachment = GL_NONE)
+  {
+    passes_[pass].reads .push_back(usage {resource, attachment});
+  }
+  void             write           (const frame_graph_pass pass, const frame_graph_resource resource, const GLenum attachment = GL_NONE)
+  {
+    passes_[pass].writes.push_back(usage {resource, attachment});
+  }
+  // The framebuffer the pass renders into, whose attachments are invalidated after their last use.
+  void             set_framebuffer (const frame_graph_pass pass, const gl::framebuffer& framebuffer)
+  {
+    passes_[pass].framebuffer = &framebuffer;
+  }
+
+  void compile()
+  {
+    statistics_ = frame_graph_statistics();
+    statistics_.passes = passes_.size();
+
+    // Culling, from the last pass backwards: a pass is kept if it has side effects or writes a resource needed later.
+    std::vector<bool> needed(resources_.size(), false);
+    for (std::size_t i = 0; i < resources_.size(); ++i)
+      needed[i] = resources_[i].output;
+    for (auto index = passes_.size(); index-- > 0;)
+    {
+      auto& pass = passes_[index];
+      pass.kept  = pass.side_effects || std::any_of(pass.writes.begin(), pass.writes.end(), [&] (const usage& value) { return needed[value.resource]; });
+      if (!pass.kept)
+      {
+        ++statistics_.culled_passes;
+        continue;
+      }
+      for (const auto& value : pass.reads)
+        needed[value.resource] = true;
+    }
+
+    // Lifetimes over the passes kept.
+    for (auto& resource : resources_)
+    {
+      resource.first    = no_pass;
+      resource.last     = no_pass;
+      resource.physical = no_physical;
+    }
+    for (std::size_t index = 0; index < passes_.size(); ++index)
+    {
+      if (!passes_[index].kept)
+        continue;
+      for (const auto* usages : {&passes_[index].reads, &passes_[index].writes})
+        for (const auto& value : *usages)
+        {
+          auto& resource = resources_[value.resource];
+          resource.first = resource.first == no_pass ? index : resource.first;
+          resource.last  = index;
+        }
+    }
+
+    // Aliasing, greedily in order of first use: each transient takes a compatible physical object whose last user has finished.
+    std::vector<frame_graph_resource> order;
+    for (std::size_t i = 0; i < resources_.size(); ++i)
+      if (resources_[i].transient() && resources_[i].first != no_pass)
+        order.push_back(i);
+    std::stable_sort(order.begin(), order.end(), [&] (const frame_graph_resource lhs, const frame_graph_resource rhs) { return resources_[lhs].first < resources_[rhs].first; });
+
+    for (auto& physical : physicals_)
+    {
+      physical.busy_until = no_pass;
+      physical.used       = false;
+    }
+    for (const auto index : order)
+    {
+      auto& resource = resources_[index];
+      auto  iterator = std::find_if(physicals_.begin(), physicals_.end(), [&] (const physical_object& physical)
+      {
+        return physical.description == resource.description && (!physical.used || physical.busy_until < resource.first);
+      });
+      if (iterator == physicals_.end())
+        iterator = create_physical(resource.description);
+      if (!iterator->used)
+      {
+        ++statistics_.physical_objects;
+        statistics_.physical_bytes += size(resource.description);
+      }
+      iterator->used       = true;
+      iterator->busy_until = resource.output ? no_pass : resource.last;
+      resource.physical    = static_cast<std::size_t>(iterator - physicals_.begin());
+
+      ++statistics_.transients;
+      statistics_.transient_bytes += size(resource.description);
+    }
+  }
+  void execute()
+  {
+    statistics_.invalidations = 0;
+    for (std::size_t index = 0; index < passes_.size(); ++index)
+    {
+      const auto& pass = passes_[index];
+      if (!pass.kept)
+        continue;
+      if (pass.function)
+        pass.function(*this);
+
+      std::vector<GLenum> attachments;
+      for (const auto* usages : {&pass.reads, &pass.writes})
+        for (const auto& value : *usages)
+        {
+          const auto& resource = resources_[value.resource];
+          if (!resource.transient() || resource.output || resource.last != index)
+            continue;
+          if (pass.framebuffer != nullptr && value.attachment != GL_NONE)
+          {
+            if (std::find(attachments.begin(), attachments.end(), value.attachment) == attachments.end())
+              attachments.push_back(value.attachment);
+          }
+          else
+            invalidate(physicals_[resource.physical]);
+        }
+      if (!attachments.empty())
+      {
+        pass.framebuffer->invalidate(attachments);
+        statistics_.invalidations += attachments.size();
+      }
+    }
+  }
+  // Removes the passes and resources, keeping the physical objects for the next frame.
+  void reset()
+  {
+    passes_   .clear();
+    resources_.clear();
+  }
+  // Releases the physical objects left unused by the last compile(). Resources of the current graph stay valid.
+  void trim ()
+  {
+    std::vector<std::size_t> remap(physicals_.size(), no_physical);
+    std::deque<physical_object> kept;
+    for (std::size_t i = 0; i < physicals_.size(); ++i)
+      if (physicals_[i].used)
+      {
+        remap[i] = kept.size();
+        kept.push_back(std::move(physicals_[i]));
+      }
+    physicals_ = std::move(kept);
+    for (auto& resource : resources_)
+      if (resource.physical != no_physical)
+        resource.physical = remap[resource.physical];
+  }
+
+  // The objects backing the resources; valid for transients after compile().
+  [[nodiscard]]
+  const texture_2d&       texture     (const frame_graph_resource resource) const
+  {
+    const auto& value = resources_[resource];
+    return value.imported_texture ? *value.imported_texture : *physicals_[value.physical].texture;
+  }
+  [[nodiscard]]
+  const gl::renderbuffer& renderbuffer(const frame_graph_resource resource) const
+  {
+    const auto& value = resources_[resource];
+    return value.imported_renderbuffer ? *value.imported_renderbuffer : *physicals_[value.physical].renderbuffer;
+  }
+  [[nodiscard]]
+  bool                    culled      (const frame_graph_pass     pass    ) const
+  {
+    return !passes_[pass].kept;
+  }
+
+  [[nodiscard]]
+  const frame_graph_statistics& statistics() const
+  {
+    return statistics_;
+  }
+  // The passes kept and culled, and the lifetime and physical object of each transient of the last compile(), one per line.
+  [[nodiscard]]
+  std::string                   report    () const
+  {
+    std::ostringstream stream;
+    for (const auto& pass : passes_)
+      stream << "pass " << pass.name << (pass.kept ? "" : " (culled)") << "\n";
+    for (const auto& resource : resources_)
+    {
+      if (!resource.transient())
+        continue;
+      stream << "transient " << resource.name;
+      if (resource.first == no_pass)
+        stream << " unused\n";
+      else
+        stream << " passes [" << resource.first << ", " << resource.last << "] physical " << resource.physical << "\n";
+    }
+    stream << "physical objects " << statistics_.physical_objects << " for " << statistics_.transients << " transients, "
+           << statistics_.physical_bytes << " of " << statistics_.transient_bytes << " bytes (" << 100.0 * statistics_.saved_ratio() << "% saved)\n";
+    return stream.str();
+  }
+
+protected:
+  static constexpr std::size_t no_pass     = std::numeric_limits<std::size_t>::max();
+  static constexpr std::size_t no_physical = std::numeric_limits<std::size_t>::max();
+
+  struct usage
+  {
+    frame_graph_resource resource  ;
+    GLenum               attachment;
+  };
+  struct pass_node
+  {
+    std::string            name        ;
+    execute_function       function    ;
+    bool                   side_effects = false;
+    std::vector<usage>     reads       ;
+    std::vector<usage>     writes      ;
+    const gl::framebuffer* framebuffer  = nullptr;
+    bool                   kept         = true;
+  };
+  struct resource_node
+  {
+    [[nodiscard]]
+    bool transient() const
+    {
+      return imported_texture == nullptr && imported_renderbuffer == nullptr;
+    }
+
+    std::string             name                 ;
+    frame_graph_description description          ;
+    const texture_2d*       imported_texture      = nullptr;
+    const gl::renderbuffer* imported_renderbuffer = nullptr;
+    bool                    output                = false;
+    std::size_t             first                 = no_pass;
+    std::size_t             last                  = no_pass;
+    std::size_t             physical              = no_physical;
+  };
+  struct physical_object
+  {
+    frame_graph_description         description;
+    std::optional<texture_2d>       texture    ;
+    std::optional<gl::renderbuffer> renderbuffer;
+    std::size_t                     busy_until = no_pass; // The last pass of the transient assigned last, no_pass for outputs.
+    bool                            used       = false;   // By the last compile().
+  };
+
+  std::deque<physical_object>::iterator create_physical(const frame_graph_description& description)
+  {
+    physical_object physical;
+    physical.description = description;
+    if (description.kind == frame_graph_description::kind_type::texture_2d)
+    {
+      physical.texture.emplace();
+      physical.texture->set_storage(description.levels, description.internal_format, description.width, description.height);
+    }
+    else
+    {
+      physical.renderbuffer.emplace();
+      if (description.samples > 0)
+        physical.renderbuffer->set_storage_multisample(description.samples, description.internal_format, description.width, description.height);
+      else
+        physical.renderbuffer->set_storage            (                     description.internal_format, description.width, description.height);
+    }
+    physicals_.push_back(std::move(physical));
+    return std::prev(physicals_.end());
+  }
+  void invalidate(const physical_object& physical)
+  {
+    if (physical.texture)
+    {
+      for (GLint level = 0; level < physical.description.levels; ++level)
+        physical.texture->invalidate(level);
+    }
+    else
+    {
+      // Renderbuffers can only be invalidated through a framebuffer. Detached afterwards, as an attachment would keep the
+      // renderbuffer alive after it is deleted (e.g. by trim()).
+      const auto attachment = attachment_point(physical.description.internal_format);
+      scratch_.attach_renderbuffer(attachment, *physical.renderbuffer);
+      scratch_.invalidate({&attachment, 1});
+      scratch_.attach_renderbuffer(attachment, gl::renderbuffer(0));
+    }
+    ++statistics_.invalidations;
+  }
+
+  static GLenum      attachment_point(const GLenum internal_format)
+  {
+    switch (internal_format)
+    {
+    case GL_DEPTH_COMPONENT16: case GL_DEPTH_COMPONENT24: case GL_DEPTH_COMPONENT32: case GL_DEPTH_COMPONENT32F:
+      return GL_DEPTH_ATTACHMENT;
+    case GL_DEPTH24_STENCIL8: case GL_DEPTH32F_STENCIL8:
+      return GL_DEPTH_STENCIL_ATTACHMENT;
+    case GL_STENCIL_INDEX8:
+      return GL_STENCIL_ATTACHMENT;
+    default:
+      return GL_COLOR_ATTACHMENT0;
+    }
+  }
+  // An estimate of the memory of a description, from the texel size of common formats (4 bytes otherwise).
+  static std::size_t size            (const frame_graph_description& description)
+  {
+    std::size_t texel = 4;
+    switch (description.internal_format)
+    {
+    case GL_R8: case GL_R8I: case GL_R8UI: case GL_STENCIL_INDEX8:
+      texel = 1; break;
+    case GL_RG8: case GL_R16: case GL_R16F: case GL_R16I: case GL_R16UI: case GL_DEPTH_COMPONENT16:
+      texel = 2; break;
+    case GL_RGBA16: case GL_RGBA16F: case GL_RGBA16I: case GL_RGBA16UI: case GL_RG32F: case GL_RG32I: case GL_RG32UI: case GL_DEPTH32F_STENCIL8:
+      texel = 8; break;
+    case GL_RGB32F: case GL_RGB32I: case GL_RGB32UI:
+      texel = 12; break;
+    case GL_RGBA32F: case GL_RGBA32I: case GL_RGBA32UI:
+      texel = 16; break;
+    default:
+      break;
+    }
+
+    std::size_t result = 0;
+    const auto  levels = description.kind == frame_graph_description::kind_type::texture_2d ? std::max(description.levels, 1) : 1;
+    for (GLsizei level = 0; level < levels; ++level)
+      result += static_cast<std::size_t>(std::max(description.width >> level, 1)) * static_cast<std::size_t>(std::max(description.height >> level, 1)) * texel;
+    return result * static_cast<std::size_t>(std::max(description.samples, 1));
+  }
+
+  std::vector<pass_node>      passes_    ;
+  std::vector<resource_node>  resources_ ;
+  std::deque<physical_object> physicals_ ;
+  gl::framebuffer             scratch_   ; // For invalidating renderbuffers.
+  frame_graph_statistics      statistics_;
+};
+}
+
+#endif
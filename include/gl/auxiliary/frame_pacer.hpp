@@ -0,0 +1,193 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_AUXILIARY_FRAME_PACER_HPP
+#define GL_AUXILIARY_FRAME_PACER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gl/opengl.hpp>
+#include <gl/sync.hpp>
+
+namespace gl
+{
+struct frame_pacer_statistics
+{
+  std::size_t              frames           = 0; // Frames ended.
+  std::size_t              blocked_frames   = 0; // Frames whose begin_frame() had to wait for the GPU.
+  std::size_t              frames_in_flight = 0; // Frames submitted but not yet known to be complete.
+  std::chrono::nanoseconds last_cpu_wait    {0}; // Time the last begin_frame() spent waiting.
+  std::chrono::nanoseconds total_cpu_wait   {0};
+  std::chrono::nanoseconds max_cpu_wait     {0};
+  std::chrono::nanoseconds last_gpu_lag     {0}; // Time from the end of the last retired frame on the CPU to its completion being observed.
+  std::chrono::nanoseconds max_gpu_lag      {0};
+};
+
+// Keeps the CPU at most frames_in_flight frames ahead of the GPU. end_frame() fences the commands of the frame; begin_frame()
+// retires the fences which have signaled and blocks only while frames_in_flight frames are still pending, polling the oldest
+// fence with zero timeouts: spinning for spin_duration first (the frame usually completes shortly), then sleeping in growing steps.
+// frames_in_flight is the single knob trading latency (low values) against throughput (high values, more CPU/GPU overlap).
+class frame_pacer
+{
+public:
+  using clock = std::chrono::steady_clock;
+
+  explicit frame_pacer  (const std::size_t frames_in_flight = 2, const std::chrono::nanoseconds spin_duration = std::chrono::microseconds(200))
+  : frames_in_flight_(std::max<std::size_t>(frames_in_flight, 1)), spin_duration_(spin_duration), fences_(frames_in_flight_)
+  {
+
+  }
+  frame_pacer           (const frame_pacer&  that) = delete;
+  frame_pacer           (      frame_pacer&& temp) = default;
+  virtual ~frame_pacer  ()                         = default;
+  frame_pacer& operator=(const frame_pacer&  that) = delete;
+  frame_pacer& operator=(      frame_pacer&& temp) = default;
+
+  void begin_frame()
+  {
+    retire();
+
+    const auto start = clock::now();
+    auto       sleep = std::chrono::microseconds(50);
+    auto       flush = true;
+    while (count_ >= frames_in_flight_)
+    {
+      // The first poll flushes, otherwise the fence may never reach the GPU.
+      if (signaled(*fences_[head_].fence, flush))
+      {
+        pop();
+        continue;
+      }
+      flush = false;
+
+      if (clock::now() - start < spin_duration_)
+        std::this_thread::yield();
+      else
+      {
+        std::this_thread::sleep_for(sleep);
+        sleep = std::min(sleep * 2, std::chrono::microseconds(1000));
+      }
+    }
+
+    const auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+    if (!flush)
+      ++statistics_.blocked_frames;
+    statistics_.last_cpu_wait    = wait;
+    statistics_.total_cpu_wait  += wait;
+    statistics_.max_cpu_wait     = std::max(statistics_.max_cpu_wait, wait);
+    statistics_.frames_in_flight = count_;
+  }
+  void end_frame  ()
+  {
+    if (count_ == fences_.size())
+      grow(fences_.size() + 1);
+
+    auto& entry = fences_[(head_ + count_) % fences_.size()];
+    entry.fence.emplace();
+    entry.submission = clock::now();
+    ++count_;
+
+    ++statistics_.frames;
+    statistics_.frames_in_flight = count_;
+  }
+  // Blocks until every submitted frame has completed, e.g. before destroying resources used by them.
+  void wait_idle  ()
+  {
+    while (count_ > 0)
+    {
+      while (fences_[head_].fence->client_wait(GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED) == GL_TIMEOUT_EXPIRED);
+      pop();
+    }
+    statistics_.frames_in_flight = 0;
+  }
+
+  void                          set_frames_in_flight(const std::size_t frames_in_flight)
+  {
+    frames_in_flight_ = std::max<std::size_t>(frames_in_flight, 1);
+    if (frames_in_flight_ > fences_.size())
+      grow(frames_in_flight_);
+  }
+  [[nodiscard]]
+  std::size_t                   frames_in_flight    () const
+  {
+    return frames_in_flight_;
+  }
+  void                          set_spin_duration   (const std::chrono::nanoseconds spin_duration)
+  {
+    spin_duration_ = spin_duration;
+  }
+  [[nodiscard]]
+  std::chrono::nanoseconds      spin_duration       () const
+  {
+    return spin_duration_;
+  }
+
+  [[nodiscard]]
+  const frame_pacer_statistics& statistics          () const
+  {
+    return statistics_;
+  }
+  void                          reset_statistics    ()
+  {
+    statistics_ = frame_pacer_statistics();
+    statistics_.frames_in_flight = count_;
+  }
+
+protected:
+  struct entry
+  {
+    std::optional<sync> fence     ;
+    clock::time_point   submission;
+  };
+
+  static bool signaled(const sync& fence, const bool flush)
+  {
+    const auto status = fence.client_wait(flush ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, 0);
+    return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED || status == GL_WAIT_FAILED;
+  }
+
+  // Retires the completed frames without waiting.
+  void retire()
+  {
+    while (count_ > 0 && signaled(*fences_[head_].fence, false))
+      pop();
+  }
+  void pop   ()
+  {
+    auto&      entry = fences_[head_];
+    const auto lag   = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - entry.submission);
+    statistics_.last_gpu_lag = lag;
+    statistics_.max_gpu_lag  = std::max(statistics_.max_gpu_lag, lag);
+
+    entry.fence.reset();
+    head_ = (head_ + 1) % fences_.size();
+    --count_;
+  }
+  // Moves the pending fences to the front of a larger ring.
+  void grow  (const std::size_t size)
+  {
+    std::vector<entry> fences(size);
+    for (std::size_t i = 0; i < count_; ++i)
+      fences[i] = std::move(fences_[(head_ + i) % fences_.size()]);
+    fences_ = std::move(fences);
+    head_   = 0;
+  }
+
+  std::size_t              frames_in_flight_;
+  std::chrono::nanoseconds spin_duration_   ;
+  std::vector<entry>       fences_          ; // Ring of pending frames, oldest at head_.
+  std::size_t              head_            = 0;
+  std::size_t              count_           = 0;
+  frame_pacer_statistics   statistics_      ;
+};
+}
+
+#endif
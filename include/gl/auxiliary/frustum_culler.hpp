@@ -0,0 +1,186 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_AUXILIARY_FRUSTUM_CULLER_HPP
+#define GL_AUXILIARY_FRUSTUM_CULLER_HPP
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <string>
+
+#include <gl/opengl.hpp>
+#include <gl/buffer.hpp>
+#include <gl/compute.hpp>
+#include <gl/draw_commands.hpp>
+#include <gl/program.hpp>
+#include <gl/shader.hpp>
+
+namespace gl
+{
+using frustum_planes = std::array<std::array<GLfloat, 4>, 6>; // Left, right, bottom, top, near, far; (a, b, c, d) with ax + by + cz + d >= 0 inside.
+
+// Extracts the normalized frustum planes of a column-major view projection matrix.
+inline frustum_planes extract_frustum_planes(const std::array<GLfloat, 16>& view_projection)
+{
+  const auto row = [&] (const std::size_t index)
+  {
+    return std::array<GLfloat, 4> {view_projection[index], view_projection[4 + index], view_projection[8 + index], view_projection[12 + index]};
+  };
+  const auto r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+
+  frustum_planes result {};
+  for (std::size_t i = 0; i < 4; ++i)
+  {
+    result[0][i] = r3[i] + r0[i];
+    result[1][i] = r3[i] - r0[i];
+    result[2][i] = r3[i] + r1[i];
+    result[3][i] = r3[i] - r1[i];
+    result[4][i] = r3[i] + r2[i];
+    result[5][i] = r3[i] - r2[i];
+  }
+  for (auto& plane : result)
+  {
+    const auto length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+    if (length > 0.0f)
+      for (auto& value : plane)
+        value /= length;
+  }
+  return result;
+}
+
+// A compute pass which culls objects against the view frustum on the GPU and appends a draw_elements_indirect_command for each
+// visible object to an output buffer, counting them with an atomic counter. draw() then issues the surviving commands through
+// multi_draw_elements_indirect_count, hence the per-object results never reach the CPU. Per object, the input buffers hold
+// (std430, indexed by object):
+// - bounds    : vec4  , a bounding sphere in object space (center, radius),
+// - transforms: mat4  , the object to world (or view) transform, in the space of the planes,
+// - commands  : draw_elements_indirect_command, the draw of the object. Its base_instance is replaced by the object index.
+// The output buffer holds up to the object count of commands. The buffers are bound to shader storage bindings [0, 4) and the
+// count buffer to binding 4 during cull().
+class frustum_culler
+{
+public:
+  explicit frustum_culler  (const GLuint local_size = 256) : local_size_(local_size)
+  {
+    shader shader(GL_COMPUTE_SHADER);
+    shader.set_source(source(local_size_));
+    if (shader.compile())
+    {
+      program_.attach_shader(shader);
+      valid_ = program_.link();
+      program_.detach_shader(shader);
+    }
+    count_buffer_.set_data_immutable(sizeof(GLuint), nullptr, GL_DYNAMIC_STORAGE_BIT);
+  }
+  frustum_culler           (const frustum_culler&  that) = delete;
+  frustum_culler           (      frustum_culler&& temp) = default;
+  virtual ~frustum_culler  ()                            = default;
+  frustum_culler& operator=(const frustum_culler&  that) = delete;
+  frustum_culler& operator=(      frustum_culler&& temp) = default;
+
+  void cull(
+    const frustum_planes& planes      ,
+    const GLuint          object_count,
+    const gl::buffer&     bounds      ,
+    const gl::buffer&     transforms  ,
+    const gl::buffer&     commands    ,
+    const gl::buffer&     output      )
+  {
+    const GLuint zero = 0;
+    count_buffer_.set_sub_data(0, sizeof(GLuint), &zero);
+
+    bounds       .bind_base(GL_SHADER_STORAGE_BUFFER, 0);
+    transforms   .bind_base(GL_SHADER_STORAGE_BUFFER, 1);
+    commands     .bind_base(GL_SHADER_STORAGE_BUFFER, 2);
+    output       .bind_base(GL_SHADER_STORAGE_BUFFER, 3);
+    count_buffer_.bind_base(GL_SHADER_STORAGE_BUFFER, 4);
+
+    program_.use();
+    for (GLint i = 0; i < 6; ++i)
+      program_.set_uniform_4f(i, planes[i]);
+    program_.set_uniform_1ui(6, object_count);
+    dispatch_compute((object_count + local_size_ - 1) / local_size_, 1, 1);
+
+    memory_barrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+  }
+  // Draws the commands written by the last cull() with the vertex array and program in use.
+  void draw(const GLenum mode, const GLenum index_type, const gl::buffer& output, const GLsizei max_draw_count) const
+  {
+    output       .bind(GL_DRAW_INDIRECT_BUFFER);
+    count_buffer_.bind(GL_PARAMETER_BUFFER    );
+    multi_draw_elements_indirect_count(mode, index_type, 0, 0, max_draw_count);
+  }
+
+  [[nodiscard]]
+  bool              is_valid    () const
+  {
+    return valid_;
+  }
+  [[nodiscard]]
+  const gl::program& program     () const
+  {
+    return program_;
+  }
+  // Holds the number of visible objects after cull(), for use as a parameter buffer or for reading back when debugging.
+  [[nodiscard]]
+  const gl::buffer&  count_buffer() const
+  {
+    return count_buffer_;
+  }
+
+protected:
+  static std::string source(const GLuint local_size)
+  {
+    return R"(#version 460
+layout(local_size_x = )" + std::to_string(local_size) + R"() in;
+
+struct draw_command
+{
+  uint count;
+  uint instance_count;
+  uint first;
+  uint base_vertex;
+  uint base_instance;
+};
+
+layout(std430, binding = 0) readonly  buffer bounds_buffer     { vec4         bounds    []; };
+layout(std430, binding = 1) readonly  buffer transforms_buffer { mat4         transforms[]; };
+layout(std430, binding = 2) readonly  buffer commands_buffer   { draw_command commands  []; };
+layout(std430, binding = 3) writeonly buffer output_buffer     { draw_command outputs   []; };
+layout(std430, binding = 4)           buffer count_buffer      { uint         draw_count  ; };
+
+layout(location = 0) uniform vec4 planes[6];
+layout(location = 6) uniform uint object_count;
+
+void main()
+{
+  const uint index = gl_GlobalInvocationID.x;
+  if (index >= object_count)
+    return;
+
+  const mat4  transform = transforms[index];
+  const vec4  center    = transform * vec4(bounds[index].xyz, 1.0);
+  const float scale     = sqrt(max(dot(transform[0].xyz, transform[0].xyz), max(dot(transform[1].xyz, transform[1].xyz), dot(transform[2].xyz, transform[2].xyz))));
+  const float radius    = bounds[index].w * scale;
+  for (int i = 0; i < 6; ++i)
+    if (dot(planes[i].xyz, center.xyz) + planes[i].w < -radius)
+      return;
+
+  draw_command command  = commands[index];
+  command.base_instance = index;
+  outputs[atomicAdd(draw_count, 1u)] = command;
+}
+)";
+  }
+
+  GLuint      local_size_  ;
+  gl::program program_     ;
+  gl::buffer  count_buffer_;
+  bool        valid_       = false;
+};
+}
+
+#endif
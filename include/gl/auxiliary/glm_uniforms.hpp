@@ -17,12 +17,14 @@ namespace gl
 template <> \
 inline void program::set_uniform        (const GLint location, const TYPE& value) \
 { \
-  glProgramUniform##GL_POSTFIX##v(id_, location, 1, glm::value_ptr(value)); \
+  if (update_uniform_shadow(location, glm::value_ptr(value), sizeof(TYPE))) \
+    glProgramUniform##GL_POSTFIX##v(id_, location, 1, glm::value_ptr(value)); \
 } \
 template <> \
 inline void program::set_uniform_vector (const GLint location, const std::vector<TYPE>& values) \
 { \
-  glProgramUniform##GL_POSTFIX##v(id_, location, (GLsizei) values.size(), glm::value_ptr(values[0])); \
+  if (update_uniform_shadow(location, glm::value_ptr(values[0]), sizeof(TYPE), (GLsizei) values.size())) \
+    glProgramUniform##GL_POSTFIX##v(id_, location, (GLsizei) values.size(), glm::value_ptr(values[0])); \
 } \
 
 SPECIALIZE_SET_UNIFORM_VECTORS(glm::ivec2, 2i )
@@ -43,12 +45,14 @@ SPECIALIZE_SET_UNIFORM_VECTORS(glm::dvec4, 4d )
 template <> \
 inline void program::set_uniform       (const GLint location, const TYPE& value) \
 { \
-  glProgramUniformMatrix##GL_POSTFIX##v(id_, location, 1, GL_FALSE, glm::value_ptr(value)); \
+  if (update_uniform_shadow(location, glm::value_ptr(value), sizeof(TYPE))) \
+    glProgramUniformMatrix##GL_POSTFIX##v(id_, location, 1, GL_FALSE, glm::value_ptr(value)); \
 } \
 template <> \
 inline void program::set_uniform_vector(const GLint location, const std::vector<TYPE>& values) \
 { \
-  glProgramUniformMatrix##GL_POSTFIX##v(id_, location, (GLsizei) values.size(), GL_FALSE, glm::value_ptr(values[0])); \
+  if (update_uniform_shadow(location, glm::value_ptr(values[0]), sizeof(TYPE), (GLsizei) values.size())) \
+    glProgramUniformMatrix##GL_POSTFIX##v(id_, location, (GLsizei) values.size(), GL_FALSE, glm::value_ptr(values[0])); \
 } \
 
 SPECIALIZE_SET_UNIFORM_MATRICES(glm::fmat2, 2f)
@@ -0,0 +1,260 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_AUXILIARY_GPU_PROFILER_HPP
+#define GL_AUXILIARY_GPU_PROFILER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <gl/opengl.hpp>
+#include <gl/debug.hpp>
+#include <gl/query.hpp>
+
+namespace gl
+{
+// A scope of a harvested frame. The scopes of a frame are stored in pre-order; parent is the index of the enclosing scope
+// (or gpu_profiler_scope::no_parent), path is the names of the enclosing scopes and the scope joined by '/'.
+struct gpu_profiler_scope
+{
+  static constexpr std::size_t no_parent = std::numeric_limits<std::size_t>::max();
+
+  std::string name    ;
+  std::string path    ;
+  std::size_t parent  = no_parent;
+  std::size_t depth   = 0;
+  double      cpu_ms  = 0.0;
+  double      gpu_ms  = 0.0;
+};
+struct gpu_profiler_frame
+{
+  std::size_t                     index  = 0; // The number of end_frame() calls before the frame ended.
+  std::vector<gpu_profiler_scope> scopes ;
+};
+// Rolling statistics over the last window samples of a scope path, in milliseconds.
+struct gpu_profiler_statistics
+{
+  std::size_t samples     = 0;
+  double      cpu_min     = 0.0;
+  double      cpu_average = 0.0;
+  double      cpu_p99     = 0.0;
+  double      gpu_min     = 0.0;
+  double      gpu_average = 0.0;
+  double      gpu_p99     = 0.0;
+};
+
+// Measures nested scopes on the CPU and GPU. Each scope writes a pair of timestamp queries taken from a recycled pool and is
+// wrapped in a debug group, so that it also shows up in graphics debuggers. Frames are harvested latency frames after they end
+// (or later, if their queries are not yet available) without stalling, through available() / result_no_wait().
+class gpu_profiler
+{
+public:
+  // RAII scope. Scopes must be destroyed in reverse order of construction. A scope still alive at end_frame() is closed there,
+  // and its destruction in a later frame does nothing.
+  class scope
+  {
+  public:
+    scope           (gpu_profiler& profiler, const std::string& name) : profiler_(profiler), frame_(profiler.frames_)
+    {
+      profiler_.begin_scope(name);
+    }
+    scope           (const scope&  that) = delete;
+    scope           (      scope&& temp) = delete;
+    virtual ~scope  ()
+    {
+      if (profiler_.frames_ == frame_)
+        profiler_.end_scope();
+    }
+    scope& operator=(const scope&  that) = delete;
+    scope& operator=(      scope&& temp) = delete;
+
+  protected:
+    gpu_profiler& profiler_;
+    std::size_t   frame_   ; // The number of end_frame() calls at construction.
+  };
+
+  explicit gpu_profiler  (const std::size_t latency = 3, const std::size_t window = 128) : latency_(latency), window_(std::max<std::size_t>(window, 1))
+  {
+
+  }
+  gpu_profiler           (const gpu_profiler&  that) = delete;
+  gpu_profiler           (      gpu_profiler&& temp) = default;
+  virtual ~gpu_profiler  ()                          = default;
+  gpu_profiler& operator=(const gpu_profiler&  that) = delete;
+  gpu_profiler& operator=(      gpu_profiler&& temp) = default;
+
+  void begin_scope(const std::string& name)
+  {
+    push_debug_group(GL_DEBUG_SOURCE_APPLICATION, 0, name);
+
+    record value;
+    value.name   = name;
+    value.path   = stack_.empty() ? name : current_.records[stack_.back()].path + "/" + name;
+    value.parent = stack_.empty() ? gpu_profiler_scope::no_parent : stack_.back();
+    value.depth  = stack_.size();
+    value.begin  = &queries_.acquire();
+    value.begin->counter();
+    value.cpu_begin = clock::now();
+
+    stack_          .push_back(current_.records.size());
+    current_.records.push_back(std::move(value));
+  }
+  void end_scope  ()
+  {
+    if (stack_.empty())
+      return;
+
+    auto& value   = current_.records[stack_.back()];
+    value.cpu_end = clock::now();
+    value.end     = &queries_.acquire();
+    value.end->counter();
+    stack_.pop_back();
+
+    pop_debug_group();
+  }
+  // Ends the frame and harvests the frames whose results are due and available.
+  void end_frame  ()
+  {
+    while (!stack_.empty())
+      end_scope();
+
+    current_.index = frames_++;
+    pending_.push_back(std::move(current_));
+    current_ = pending_frame();
+
+    while (!pending_.empty() && frames_ - pending_.front().index > latency_ && harvest(pending_.front()))
+      pending_.pop_front();
+  }
+
+  // The last harvested frame.
+  [[nodiscard]]
+  const gpu_profiler_frame& frame     () const
+  {
+    return frame_;
+  }
+  [[nodiscard]]
+  gpu_profiler_statistics   statistics(const std::string& path) const
+  {
+    gpu_profiler_statistics result;
+    const auto iterator = histories_.find(path);
+    if (iterator == histories_.end() || iterator->second.empty())
+      return result;
+
+    const auto summarize = [ ] (std::vector<double> samples, double& minimum, double& average, double& p99)
+    {
+      minimum = *std::min_element(samples.begin(), samples.end());
+      average = 0.0;
+      for (const auto sample : samples)
+        average += sample;
+      average /= static_cast<double>(samples.size());
+      const auto rank = static_cast<std::size_t>(0.99 * static_cast<double>(samples.size() - 1) + 0.5);
+      std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+      p99 = samples[rank];
+    };
+
+    const auto& history = iterator->second;
+    std::vector<double> cpu(history.size()), gpu(history.size());
+    for (std::size_t i = 0; i < history.size(); ++i)
+      std::tie(cpu[i], gpu[i]) = history[i];
+    result.samples = history.size();
+    summarize(std::move(cpu), result.cpu_min, result.cpu_average, result.cpu_p99);
+    summarize(std::move(gpu), result.gpu_min, result.gpu_average, result.gpu_p99);
+    return result;
+  }
+  // The paths of every scope seen, for iterating statistics.
+  [[nodiscard]]
+  std::vector<std::string>  paths     () const
+  {
+    std::vector<std::string> result;
+    result.reserve(histories_.size());
+    for (const auto& [path, history] : histories_)
+      result.push_back(path);
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+
+  [[nodiscard]]
+  std::size_t latency() const
+  {
+    return latency_;
+  }
+  [[nodiscard]]
+  std::size_t window () const
+  {
+    return window_;
+  }
+
+protected:
+  using clock = std::chrono::steady_clock;
+
+  struct record
+  {
+    std::string            name     ;
+    std::string            path     ;
+    std::size_t            parent   = gpu_profiler_scope::no_parent;
+    std::size_t            depth    = 0;
+    const timestamp_query* begin    = nullptr;
+    const timestamp_query* end      = nullptr;
+    clock::time_point      cpu_begin;
+    clock::time_point      cpu_end  ;
+  };
+  struct pending_frame
+  {
+    std::size_t         index   = 0;
+    std::vector<record> records ;
+  };
+
+  // Returns false, leaving the frame pending, if any of its queries is not yet available.
+  bool harvest(pending_frame& pending)
+  {
+    for (const auto& value : pending.records)
+      if (!value.end->available())
+        return false;
+
+    frame_.index = pending.index;
+    frame_.scopes.clear();
+    for (const auto& value : pending.records)
+    {
+      gpu_profiler_scope result;
+      result.name   = value.name  ;
+      result.path   = value.path  ;
+      result.parent = value.parent;
+      result.depth  = value.depth ;
+      result.cpu_ms = std::chrono::duration<double, std::milli>(value.cpu_end - value.cpu_begin).count();
+      result.gpu_ms = static_cast<double>(value.end->result_no_wait() - value.begin->result_no_wait()) / 1e6;
+
+      auto& history = histories_[result.path];
+      history.emplace_back(result.cpu_ms, result.gpu_ms);
+      if (history.size() > window_)
+        history.pop_front();
+
+      queries_.release(*value.begin);
+      queries_.release(*value.end  );
+      frame_.scopes.push_back(std::move(result));
+    }
+    return true;
+  }
+
+  std::size_t                                                           latency_  ;
+  std::size_t                                                           window_   ;
+  query_pool<GL_TIMESTAMP>                                              queries_  ;
+  pending_frame                                                         current_  ;
+  std::vector<std::size_t>                                              stack_    ; // Indices of the open scopes in current_.records.
+  std::deque<pending_frame>                                             pending_  ;
+  std::size_t                                                           frames_   = 0;
+  gpu_profiler_frame                                                    frame_    ;
+  std::unordered_map<std::string, std::deque<std::pair<double, double>>> histories_; // CPU and GPU milliseconds per path.
+};
+}
+
+#endif
@@ -0,0 +1,465 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_AUXILIARY_HI_Z_CULLER_HPP
+#define GL_AUXILIARY_HI_Z_CULLER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gl/opengl.hpp>
+#include <gl/buffer.hpp>
+#include <gl/compute.hpp>
+#include <gl/draw_commands.hpp>
+#include <gl/program.hpp>
+#include <gl/query.hpp>
+#include <gl/shader.hpp>
+#include <gl/sync.hpp>
+#include <gl/texture.hpp>
+
+namespace gl
+{
+struct hi_z_statistics
+{
+  std::size_t objects          = 0; // Of the last harvested cull.
+  std::size_t visible          = 0; // Of the last harvested cull.
+  std::size_t culled           = 0; // Of the last harvested cull.
+  std::size_t culls            = 0; // Culls harvested.
+  std::size_t builds           = 0; // Pyramid builds harvested.
+  double      pyramid_ms       = 0.0; // GPU time of the last harvested pyramid build.
+  double      pyramid_ms_sum   = 0.0;
+
+  [[nodiscard]]
+  double average_pyramid_ms() const
+  {
+    return builds > 0 ? pyramid_ms_sum / static_cast<double>(builds) : 0.0;
+  }
+  [[nodiscard]]
+  double culled_ratio      () const
+  {
+    return objects > 0 ? static_cast<double>(culled) / static_cast<double>(objects) : 0.0;
+  }
+};
+
+// Hierarchical depth (Hi-Z) occlusion culling. build() reduces a depth texture into a pyramid holding the minimum and maximum
+// depth of each texel footprint (RG32F, a full mip chain), and cull() tests the screen space bounds of each object against the
+// pyramid level where they cover at most 2x2 texels, on the GPU. Per object, the buffers hold (std430, indexed by object):
+// - bounds    : vec4[2], the world space axis aligned bounding box (minimum, maximum; w ignored),
+// - commands  : draw_elements_indirect_command, the draw of the object,
+// - output    : draw_elements_indirect_command, a copy of the command with instance_count zeroed if the object is culled,
+// - visibility: uint, 1 if the object is visible and 0 otherwise.
+// Objects outside the frustum are culled as well; objects crossing the near plane are always visible. The depth is usually last
+// frame's, hence objects disoccluded this frame may pop in for a frame. The depth texture must not be multisampled and must have
+// its compare mode set to GL_NONE. The buffers are bound to shader storage bindings [0, 5), the depth or pyramid to texture unit
+// 0 and the pyramid levels to image unit 0 during build() and cull().
+// The visible and culled counts are copied to a persistently mapped buffer and the pyramid build is timed with a time elapsed
+// query; both are harvested by later calls without waiting, hence statistics() lags a few frames behind.
+class hi_z_culler
+{
+public:
+  explicit hi_z_culler  (const bool reversed_depth = false, const bool zero_to_one_depth = false, const std::size_t readback_slots = 4)
+  : reversed_depth_(reversed_depth), zero_to_one_depth_(zero_to_one_depth), fences_(std::max<std::size_t>(readback_slots, 1)), slot_objects_(fences_.size(), 0)
+  {
+    valid_ = create(build_program_, build_source()) && create(cull_program_, cull_source());
+
+    counters_.set_data_immutable(2 * sizeof(GLuint), nullptr, GL_DYNAMIC_STORAGE_BIT);
+    readback_.set_data_immutable(static_cast<GLsizeiptr>(fences_.size() * 2 * sizeof(GLuint)), nullptr, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    mapped_ = static_cast<const GLuint*>(readback_.map_range(0, readback_.size(), GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT));
+  }
+  hi_z_culler           (const hi_z_culler&  that) = delete;
+  hi_z_culler           (      hi_z_culler&& temp) = default;
+  virtual ~hi_z_culler  ()                         = default;
+  hi_z_culler& operator=(const hi_z_culler&  that) = delete;
+  hi_z_culler& operator=(      hi_z_culler&& temp) = default;
+
+  // Builds the pyramid from a depth texture of the given size, reallocating the pyramid when the size changes.
+  void build(const texture_2d& depth, const GLsizei width, const GLsizei height)
+  {
+    harvest();
+    if (width != width_ || height != height_)
+      allocate(width, height);
+
+    const auto& timer = timers_.acquire();
+    timer.begin();
+
+    build_program_.use();
+    depth.bind_unit(0);
+    for (GLint level = 0; level < levels_; ++level)
+    {
+      const auto source_size      = level_size(std::max(level - 1, 0));
+      const auto destination_size = level_size(level);
+      if (level == 1)
+        pyramid_.bind_unit(0);
+
+      pyramid_.bind_image_texture(0, level, false, 0, GL_WRITE_ONLY, GL_RG32F);
+      build_program_.set_uniform_1i(0, level - 1);
+      build_program_.set_uniform_2i(1, source_size     );
+      build_program_.set_uniform_2i(2, destination_size);
+      dispatch_compute((destination_size[0] + 7) / 8, (destination_size[1] + 7) / 8, 1);
+
+      memory_barrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    }
+
+    time_elapsed_query::end();
+    pending_timers_.push_back(&timer);
+  }
+  // Culls object_count objects against the last built pyramid with the view projection (column-major) the depth was rendered with.
+  void cull(
+    const std::array<GLfloat, 16>& view_projection,
+    const GLuint                   object_count   ,
+    const gl::buffer&              bounds         ,
+    const gl::buffer&              commands       ,
+    const gl::buffer&              output         ,
+    const gl::buffer&              visibility     )
+  {
+    harvest();
+    if (object_count == 0 || levels_ == 0)
+      return;
+
+    const std::array<GLuint, 2> zeros {};
+    counters_.set_sub_data(0, sizeof(zeros), zeros.data());
+
+    bounds    .bind_base(GL_SHADER_STORAGE_BUFFER, 0);
+    commands  .bind_base(GL_SHADER_STORAGE_BUFFER, 1);
+    output    .bind_base(GL_SHADER_STORAGE_BUFFER, 2);
+    visibility.bind_base(GL_SHADER_STORAGE_BUFFER, 3);
+    counters_ .bind_base(GL_SHADER_STORAGE_BUFFER, 4);
+    pyramid_  .bind_unit(0);
+
+    cull_program_.use();
+    cull_program_.set_uniform_matrix_44f(0, view_projection, false);
+    cull_program_.set_uniform_1ui       (1, object_count);
+    cull_program_.set_uniform_2i        (2, std::array<GLint, 2> {width_, height_});
+    cull_program_.set_uniform_1i        (3, levels_);
+    cull_program_.set_uniform_1ui       (4, reversed_depth_    ? 1 : 0);
+    cull_program_.set_uniform_1ui       (5, zero_to_one_depth_ ? 1 : 0);
+    dispatch_compute((object_count + 63) / 64, 1, 1);
+
+    memory_barrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    // The counts are read back through a free slot of the ring; if every slot is in flight, this cull goes uncounted.
+    if (!fences_[slot_])
+    {
+      readback_.copy_sub_data(counters_, 0, static_cast<GLintptr>(slot_ * 2 * sizeof(GLuint)), 2 * sizeof(GLuint));
+      fences_      [slot_].emplace();
+      slot_objects_[slot_] = object_count;
+      slot_ = (slot_ + 1) % fences_.size();
+    }
+  }
+  // Draws the commands written by the last cull() with the vertex array and program in use.
+  static void draw(const GLenum mode, const GLenum index_type, const gl::buffer& output, const GLsizei object_count)
+  {
+    output.bind(GL_DRAW_INDIRECT_BUFFER);
+    multi_draw_elements_indirect(mode, index_type, 0, object_count);
+  }
+
+  [[nodiscard]]
+  bool                   is_valid        () const
+  {
+    return valid_;
+  }
+  [[nodiscard]]
+  const texture_2d&      pyramid         () const
+  {
+    return pyramid_;
+  }
+  [[nodiscard]]
+  GLint                  levels          () const
+  {
+    return levels_;
+  }
+  // Holds the visible and culled counts of the last cull(), for use as a parameter buffer or for reading back when debugging.
+  [[nodiscard]]
+  const gl::buffer&      counters        () const
+  {
+    return counters_;
+  }
+  [[nodiscard]]
+  const hi_z_statistics& statistics      () const
+  {
+    return statistics_;
+  }
+  void                   reset_statistics()
+  {
+    statistics_ = hi_z_statistics();
+  }
+
+protected:
+  static bool create(gl::program& program, const std::string& source)
+  {
+    shader shader(GL_COMPUTE_SHADER);
+    shader.set_source(source);
+    if (!shader.compile())
+      return false;
+    program.attach_shader(shader);
+    const auto result = program.link();
+    program.detach_shader(shader);
+    return result;
+  }
+
+  static std::string build_source()
+  {
+    return R"(#version 460
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = 0)        uniform sampler2D source; // The depth for level 0, the pyramid otherwise.
+layout(binding = 0, rg32f) uniform writeonly image2D destination;
+
+layout(location = 0) uniform int   source_level;
+layout(location = 1) uniform ivec2 source_size;
+layout(location = 2) uniform ivec2 destination_size;
+
+void main()
+{
+  const ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+  if (any(greaterThanEqual(texel, destination_size)))
+    return;
+
+  if (source_level < 0)
+  {
+    const float depth = texelFetch(source, texel, 0).r;
+    imageStore(destination, texel, vec4(depth, depth, 0.0, 0.0));
+    return;
+  }
+
+  // Odd sizes fold the last row or column into the footprints, so that every source texel is covered.
+  const ivec2 extent = ivec2(2) + ivec2(notEqual(source_size & 1, ivec2(0)));
+  vec2 result = vec2(1.0, 0.0);
+  for (int y = 0; y < extent.y; ++y)
+    for (int x = 0; x < extent.x; ++x)
+    {
+      const vec2 value = texelFetch(source, min(texel * 2 + ivec2(x, y), source_size - 1), source_level).rg;
+      result = vec2(min(result.x, value.x), max(result.y, value.y));
+    }
+  imageStore(destination, texel, vec4(result, 0.0, 0.0));
+}
+)";
+  }
+  static std::string cull_source ()
+  {
+    return R"(#version 460
+layout(local_size_x = 64) in;
+
+struct draw_command
+{
+  uint count;
+  uint instance_count;
+  uint first;
+  uint base_vertex;
+  uint base_instance;
+};
+
+layout(std430, binding = 0) readonly  buffer bounds_buffer     { vec4         bounds    []; };
+layout(std430, binding = 1) readonly  buffer commands_buffer   { draw_command commands  []; };
+layout(std430, binding = 2) writeonly buffer output_buffer     { draw_command outputs   []; };
+layout(std430, binding = 3) writeonly buffer visibility_buffer { uint         visibility[]; };
+layout(std430, binding = 4)           buffer counters_buffer   { uint visible_count; uint culled_count; };
+
+layout(binding = 0) uniform sampler2D pyramid;
+
+layout(location = 0) uniform mat4  view_projection;
+layout(location = 1) uniform uint  object_count;
+layout(location = 2) uniform ivec2 pyramid_size;
+layout(location = 3) uniform int   pyramid_levels;
+layout(location = 4) uniform uint  reversed_depth;
+layout(location = 5) uniform uint  zero_to_one_depth;
+
+bool test(const vec3 minimum, const vec3 maximum)
+{
+  vec3 ndc_minimum = vec3( 1e30);
+  vec3 ndc_maximum = vec3(-1e30);
+  for (int i = 0; i < 8; ++i)
+  {
+    const vec3 corner = vec3((i & 1) != 0 ? maximum.x : minimum.x, (i & 2) != 0 ? maximum.y : minimum.y, (i & 4) != 0 ? maximum.z : minimum.z);
+    const vec4 clip   = view_projection * vec4(corner, 1.0);
+    if (clip.w <= 0.0)
+      return true;
+    const vec3 ndc = clip.xyz / clip.w;
+    ndc_minimum = min(ndc_minimum, ndc);
+    ndc_maximum = max(ndc_maximum, ndc);
+  }
+  if (any(greaterThan(ndc_minimum.xy, vec2(1.0))) || any(lessThan(ndc_maximum.xy, vec2(-1.0))))
+    return false;
+
+  const vec2  uv_minimum = clamp(ndc_minimum.xy * 0.5 + 0.5, 0.0, 1.0);
+  const vec2  uv_maximum = clamp(ndc_maximum.xy * 0.5 + 0.5, 0.0, 1.0);
+  const vec2  extent     = (uv_maximum - uv_minimum) * vec2(pyramid_size);
+  const int   level      = clamp(int(ceil(log2(max(max(extent.x, extent.y), 1.0)))), 0, pyramid_levels - 1);
+  const ivec2 size       = max(pyramid_size >> level, ivec2(1));
+  const ivec2 first      = min(ivec2(uv_minimum * vec2(size)), size - 1);
+  const ivec2 last       = min(ivec2(uv_maximum * vec2(size)), min(size - 1, first + 1));
+
+  // The farthest occluder depth over the footprint against the nearest depth of the bounds.
+  float occluder = reversed_depth != 0u ? 1.0 : 0.0;
+  for (int y = first.y; y <= last.y; ++y)
+    for (int x = first.x; x <= last.x; ++x)
+    {
+      const vec2 value = texelFetch(pyramid, ivec2(x, y), level).rg;
+      occluder = reversed_depth != 0u ? min(occluder, value.x) : max(occluder, value.y);
+    }
+
+  const vec2 depth = zero_to_one_depth != 0u ? vec2(ndc_minimum.z, ndc_maximum.z) : vec2(ndc_minimum.z, ndc_maximum.z) * 0.5 + 0.5;
+  return reversed_depth != 0u ? depth.y >= occluder : depth.x <= occluder;
+}
+
+void main()
+{
+  const uint index = gl_GlobalInvocationID.x;
+  if (index >= object_count)
+    return;
+
+  const bool   visible = test(bounds[2u * index].xyz, bounds[2u * index + 1u].xyz);
+  draw_command command = commands[index];
+  if (!visible)
+    command.instance_count = 0u;
+  outputs   [index] = command;
+  visibility[index] = visible ? 1u : 0u;
+  atomicAdd(visible ? visible_count : culled_count, 1u);
+}
+)";
+  }
+
+  void allocate(const GLsizei width, const GLsizei height)
+  {
+    width_  = width ;
+    height_ = height;
+    levels_ = 1;
+    while ((std::max(width_, height_) >> levels_) > 0)
+      ++levels_;
+
+    pyramid_ = texture_2d();
+    pyramid_.set_storage     (levels_, GL_RG32F, width_, height_);
+    pyramid_.set_min_filter  (GL_NEAREST_MIPMAP_NEAREST);
+    pyramid_.set_mag_filter  (GL_NEAREST);
+  }
+  [[nodiscard]]
+  std::array<GLint, 2> level_size(const GLint level) const
+  {
+    return {std::max(width_ >> level, 1), std::max(height_ >> level, 1)};
+  }
+
+  // Applies the available results without waiting, oldest first, so that the latest wins.
+  void harvest()
+  {
+    for (std::size_t i = 0; i < fences_.size(); ++i)
+    {
+      const auto slot = (slot_ + i) % fences_.size();
+      if (!fences_[slot])
+        continue;
+      const auto status = fences_[slot]->client_wait(0, 0);
+      if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        continue;
+
+      statistics_.objects = slot_objects_[slot];
+      statistics_.visible = mapped_[2 * slot    ];
+      statistics_.culled  = mapped_[2 * slot + 1];
+      ++statistics_.culls;
+      fences_[slot].reset();
+    }
+
+    auto kept = pending_timers_.begin();
+    for (auto iterator = pending_timers_.begin(); iterator != pending_timers_.end(); ++iterator)
+    {
+      if (!(*iterator)->available())
+      {
+        *kept++ = *iterator;
+        continue;
+      }
+      statistics_.pyramid_ms      = static_cast<double>((*iterator)->result_no_wait()) / 1e6;
+      statistics_.pyramid_ms_sum += statistics_.pyramid_ms;
+      ++statistics_.builds;
+      timers_.release(**iterator);
+    }
+    pending_timers_.erase(kept, pending_timers_.end());
+  }
+
+  bool                                   reversed_depth_   ;
+  bool                                   zero_to_one_depth_;
+  gl::program                            build_program_    ;
+  gl::program                            cull_program_     ;
+  bool                                   valid_            = false;
+  texture_2d                             pyramid_          ;
+  GLsizei                                width_            = 0;
+  GLsizei                                height_           = 0;
+  GLint                                  levels_           = 0;
+  gl::buffer                             counters_         ;
+  gl::buffer                             readback_         ; // Persistently mapped ring of counters.
+  const GLuint*                          mapped_           = nullptr;
+  std::vector<std::optional<sync>>       fences_           ;
+  std::vector<GLuint>                    slot_objects_     ;
+  std::size_t                            slot_             = 0;
+  query_pool<GL_TIME_ELAPSED>            timers_           ;
+  std::vector<const time_elapsed_query*> pending_timers_   ;
+  hi_z_statistics                        statistics_       ;
+};
+
+// The fallback without compute: each object owns an occlusion query, which its bounds are drawn into (usually with color and
+// depth writes disabled) between begin_test() and end_test(), and its draws between begin_draw() and end_draw() are rendered
+// conditionally on the last test, hence the GPU skips occluded draws without the client ever reading a result. Objects never
+// tested are drawn unconditionally. The queries are created in bulk by a query_pool.
+template<GLenum target = GL_ANY_SAMPLES_PASSED>
+class conditional_render_culler
+{
+public:
+  explicit conditional_render_culler  (const std::size_t object_count = 0) : pool_(0, std::max<std::size_t>(object_count, 32))
+  {
+    resize(object_count);
+  }
+  conditional_render_culler           (const conditional_render_culler&  that) = delete;
+  conditional_render_culler           (      conditional_render_culler&& temp) = default;
+  virtual ~conditional_render_culler  ()                                       = default;
+  conditional_render_culler& operator=(const conditional_render_culler&  that) = delete;
+  conditional_render_culler& operator=(      conditional_render_culler&& temp) = default;
+
+  void resize    (const std::size_t object_count)
+  {
+    while (queries_.size() < object_count)
+      queries_.push_back(&pool_.acquire());
+    tested_.resize(queries_.size(), false);
+  }
+
+  void begin_test(const std::size_t object)
+  {
+    if (object >= queries_.size())
+      resize(object + 1);
+    queries_[object]->begin();
+    tested_ [object] = true;
+  }
+  static void end_test()
+  {
+    query<target>::end();
+  }
+  void begin_draw(const std::size_t object, const GLenum mode = GL_QUERY_BY_REGION_NO_WAIT)
+  {
+    conditional_ = object < queries_.size() && tested_[object];
+    if (conditional_)
+      queries_[object]->begin_conditional_render(mode);
+  }
+  void end_draw  ()
+  {
+    if (conditional_)
+      query<target>::end_conditional_render();
+    conditional_ = false;
+  }
+
+  [[nodiscard]]
+  std::size_t object_count() const
+  {
+    return queries_.size();
+  }
+
+protected:
+  query_pool<target>                pool_       ;
+  std::vector<const query<target>*> queries_    ; // Per object, never released.
+  std::vector<bool>                 tested_     ;
+  bool                              conditional_ = false;
+};
+}
+
+#endif
@@ -0,0 +1,217 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_AUXILIARY_INDIRECT_BATCHER_HPP
+#define GL_AUXILIARY_INDIRECT_BATCHER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <gl/opengl.hpp>
+#include <gl/buffer.hpp>
+#include <gl/draw_commands.hpp>
+#include <gl/program.hpp>
+#include <gl/render_state.hpp>
+#include <gl/sync.hpp>
+#include <gl/vertex_array.hpp>
+
+namespace gl
+{
+struct indirect_batcher_statistics
+{
+  std::size_t draws          = 0; // Draws added.
+  std::size_t indirect_calls = 0; // multi_draw_elements_indirect calls issued for them.
+  std::size_t merged_draws   = 0; // Draws which did not need a call of their own, i.e. draws - indirect_calls - fallback_draws.
+  std::size_t fallback_draws = 0; // Draws issued directly since the frame's part of the indirect buffer was full.
+  std::size_t frame_waits    = 0; // Times next_frame() waited on the GPU before reusing a part of the indirect buffer.
+};
+
+// Collects indexed draws and issues each run of consecutive draws sharing program, vertex array, render state, mode and index type
+// as a single multi_draw_elements_indirect call, preserving the submission order. If reordering is enabled, flush() first sorts
+// the pending draws by their state so that all compatible draws merge, which is only correct if their order does not matter
+// (e.g. opaque geometry with depth testing, as opposed to blending). The commands are written into a persistently mapped indirect buffer split into one part
+// per frame in flight; next_frame() fences the current part and waits only if the next one is still in use by the GPU.
+// add() returns the index of the draw within the frame, which is passed as its base_instance, hence shaders can fetch per-draw
+// data with gl_BaseInstance (ARB_shader_draw_parameters) or through instanced vertex attributes.
+class indirect_batcher
+{
+public:
+  explicit indirect_batcher  (const GLsizei capacity = 65536, const std::size_t frames_in_flight = 3)
+  : capacity_(capacity), fences_(std::max<std::size_t>(frames_in_flight, 1))
+  {
+    const auto flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const auto size  = static_cast<GLsizeiptr>(capacity_ * fences_.size() * sizeof(draw_elements_indirect_command));
+    buffer_.set_data_immutable(size, nullptr, flags);
+    commands_ = static_cast<draw_elements_indirect_command*>(buffer_.map_range(0, size, flags));
+  }
+  indirect_batcher           (const indirect_batcher&  that) = delete;
+  indirect_batcher           (      indirect_batcher&& temp) = default;
+  virtual ~indirect_batcher  ()                              = default;
+  indirect_batcher& operator=(const indirect_batcher&  that) = delete;
+  indirect_batcher& operator=(      indirect_batcher&& temp) = default;
+
+  // The offset is the index of the first index within the element array buffer of the vertex array.
+  GLuint add       (
+    const gl::program&      program       ,
+    const gl::vertex_array& vertex_array  ,
+    const render_state*     state         ,
+    const GLenum            mode          ,
+    const GLenum            index_type    ,
+    const GLuint            count         ,
+    const GLuint            first_index   = 0,
+    const GLint             base_vertex   = 0,
+    const GLuint            instance_count = 1)
+  {
+    const auto index = frame_draws_++;
+    pending_.push_back(draw {&program, &vertex_array, state, mode, index_type,
+      draw_elements_indirect_command {count, instance_count, first_index, static_cast<GLuint>(base_vertex), index}});
+    ++statistics_.draws;
+    return index;
+  }
+  // Issues the pending draws. Called by next_frame(); call it earlier to draw before other commands.
+  void   flush     ()
+  {
+    if (pending_.empty())
+      return;
+
+    if (reorder_)
+      std::sort(pending_.begin(), pending_.end(), [ ] (const draw& lhs, const draw& rhs)
+      {
+        return std::make_tuple(lhs.program->id(), lhs.vertex_array->id(), lhs.state, lhs.mode, lhs.index_type, lhs.command.base_instance) <
+               std::make_tuple(rhs.program->id(), rhs.vertex_array->id(), rhs.state, rhs.mode, rhs.index_type, rhs.command.base_instance);
+      });
+
+    buffer_.bind(GL_DRAW_INDIRECT_BUFFER);
+    for (std::size_t begin = 0, end = 0; begin < pending_.size(); begin = end)
+    {
+      const auto& first = pending_[begin];
+      end = begin + 1;
+      while (end < pending_.size() && compatible(first, pending_[end]))
+        ++end;
+
+      first.program     ->use ();
+      first.vertex_array->bind();
+      if (first.state != nullptr)
+        render_state::apply(*first.state);
+
+      const auto size       = static_cast<GLsizei>(end - begin);
+      const auto batch_size = std::min(size, capacity_ - frame_commands_);
+      if (batch_size > 0)
+      {
+        const auto offset = static_cast<GLsizei>(frame_ * capacity_ + frame_commands_);
+        for (GLsizei i = 0; i < batch_size; ++i)
+          commands_[offset + i] = pending_[begin + i].command;
+        multi_draw_elements_indirect(first.mode, first.index_type, static_cast<GLint>(offset * sizeof(draw_elements_indirect_command)), batch_size);
+        frame_commands_ += batch_size;
+        ++statistics_.indirect_calls;
+        statistics_.merged_draws += batch_size - 1;
+      }
+      for (auto i = begin + batch_size; i < end; ++i)
+      {
+        const auto& command = pending_[i].command;
+        draw_elements_instanced_base_vertex_base_instance(first.mode, static_cast<GLsizei>(command.count), first.index_type,
+          reinterpret_cast<const void*>(static_cast<std::size_t>(command.first) * index_size(first.index_type)), static_cast<GLsizei>(command.instance_count),
+          static_cast<GLint>(command.base_vertex), command.base_instance);
+        ++statistics_.fallback_draws;
+      }
+    }
+    pending_.clear();
+  }
+  // Flushes, fences the current part of the indirect buffer and moves to the next part, waiting for the GPU to release it if necessary.
+  void   next_frame()
+  {
+    flush();
+
+    fences_[frame_] = std::make_unique<sync>();
+    frame_          = (frame_ + 1) % static_cast<GLsizei>(fences_.size());
+    frame_draws_    = 0;
+    frame_commands_ = 0;
+
+    if (auto& fence = fences_[frame_])
+    {
+      auto status = fence->client_wait(0, 0);
+      if (status == GL_TIMEOUT_EXPIRED)
+      {
+        ++statistics_.frame_waits;
+        while (status == GL_TIMEOUT_EXPIRED)
+          status = fence->client_wait(GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+      }
+      fence.reset();
+    }
+  }
+
+  [[nodiscard]]
+  const gl::buffer&                  buffer          () const
+  {
+    return buffer_;
+  }
+  [[nodiscard]]
+  GLsizei                            capacity        () const
+  {
+    return capacity_;
+  }
+  [[nodiscard]]
+  std::size_t                        pending         () const
+  {
+    return pending_.size();
+  }
+  void                               set_reorder     (const bool reorder)
+  {
+    reorder_ = reorder;
+  }
+  [[nodiscard]]
+  bool                               reorder         () const
+  {
+    return reorder_;
+  }
+
+  [[nodiscard]]
+  const indirect_batcher_statistics& statistics      () const
+  {
+    return statistics_;
+  }
+  void                               reset_statistics()
+  {
+    statistics_ = indirect_batcher_statistics();
+  }
+
+protected:
+  struct draw
+  {
+    const gl::program*             program     ;
+    const gl::vertex_array*        vertex_array;
+    const render_state*            state       ;
+    GLenum                         mode        ;
+    GLenum                         index_type  ;
+    draw_elements_indirect_command command     ;
+  };
+
+  static bool        compatible(const draw& lhs, const draw& rhs)
+  {
+    return lhs.program->id() == rhs.program->id() && lhs.vertex_array->id() == rhs.vertex_array->id() && lhs.state == rhs.state && lhs.mode == rhs.mode && lhs.index_type == rhs.index_type;
+  }
+  static std::size_t index_size(const GLenum index_type)
+  {
+    return index_type == GL_UNSIGNED_BYTE ? 1 : index_type == GL_UNSIGNED_SHORT ? 2 : 4;
+  }
+
+  GLsizei                            capacity_       ; // Commands per frame in flight.
+  gl::buffer                         buffer_         ;
+  draw_elements_indirect_command*    commands_       = nullptr;
+  std::vector<std::unique_ptr<sync>> fences_         ;
+  GLsizei                            frame_          = 0;
+  GLuint                             frame_draws_    = 0;
+  GLsizei                            frame_commands_ = 0;
+  bool                               reorder_        = false;
+  std::vector<draw>                  pending_        ;
+  indirect_batcher_statistics        statistics_     ;
+};
+}
+
+#endif
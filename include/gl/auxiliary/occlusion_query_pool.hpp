@@ -0,0 +1,157 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_AUXILIARY_OCCLUSION_QUERY_POOL_HPP
+#define GL_AUXILIARY_OCCLUSION_QUERY_POOL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <gl/opengl.hpp>
+#include <gl/query.hpp>
+
+namespace gl
+{
+struct occlusion_query_statistics
+{
+  std::size_t queries_issued  = 0;
+  std::size_t results         = 0; // Results harvested.
+  std::size_t pending         = 0; // Queries issued but not yet available.
+  std::size_t latency_sum     = 0; // Frames between issuing and harvesting, summed over the results.
+  std::size_t maximum_latency = 0;
+  std::size_t pool_size       = 0;
+
+  [[nodiscard]]
+  double average_latency() const
+  {
+    return results > 0 ? static_cast<double>(latency_sum) / static_cast<double>(results) : 0.0;
+  }
+};
+
+// Tracks the visibility of objects (indexed [0, object count)) through occlusion queries taken from a query_pool, which creates
+// them in bulk and recycles them. begin_frame() harvests the queries whose results are available without waiting; until a
+// result arrives, visible() keeps returning the last known visibility (true for objects never tested, so that they get drawn
+// and tested). Usually the bounds or the object itself is drawn between begin(object) and end() when visible, or its bounds
+// with color and depth writes disabled otherwise.
+template<GLenum target = GL_ANY_SAMPLES_PASSED>
+class occlusion_query_pool
+{
+public:
+  explicit occlusion_query_pool  (const std::size_t object_count = 0, const std::size_t pool_size = 1024)
+  : queries_(pool_size, std::max<std::size_t>(pool_size / 4, 1)), visible_(object_count, true), in_flight_(object_count, 0)
+  {
+
+  }
+  occlusion_query_pool           (const occlusion_query_pool&  that) = delete;
+  occlusion_query_pool           (      occlusion_query_pool&& temp) = default;
+  virtual ~occlusion_query_pool  ()                                  = default;
+  occlusion_query_pool& operator=(const occlusion_query_pool&  that) = delete;
+  occlusion_query_pool& operator=(      occlusion_query_pool&& temp) = default;
+
+  void resize     (const std::size_t object_count)
+  {
+    visible_  .resize(object_count, true);
+    in_flight_.resize(object_count, 0   );
+  }
+  void begin_frame()
+  {
+    ++frame_;
+    harvest();
+  }
+
+  void begin      (const std::size_t object)
+  {
+    if (object >= visible_.size())
+      resize(object + 1);
+
+    const auto& value = queries_.acquire();
+    value.begin();
+    pending_.push_back(pending_query {object, &value, frame_});
+    ++in_flight_[object];
+    ++statistics_.queries_issued;
+  }
+  void end        ()
+  {
+    query<target>::end();
+  }
+
+  // Returns the result of the last harvested query of the object, or true if none.
+  [[nodiscard]]
+  bool        visible     (const std::size_t object) const
+  {
+    return object >= visible_.size() || visible_[object];
+  }
+  // Returns whether a query of the object is still in flight, e.g. to skip issuing another one.
+  [[nodiscard]]
+  bool        in_flight   (const std::size_t object) const
+  {
+    return object < in_flight_.size() && in_flight_[object] > 0;
+  }
+  [[nodiscard]]
+  std::size_t object_count() const
+  {
+    return visible_.size();
+  }
+
+  [[nodiscard]]
+  const occlusion_query_statistics& statistics      () const
+  {
+    return statistics_;
+  }
+  void                              reset_statistics()
+  {
+    statistics_ = occlusion_query_statistics();
+  }
+
+protected:
+  struct pending_query
+  {
+    std::size_t              object;
+    const gl::query<target>* query ;
+    std::size_t              frame ;
+  };
+
+  // Applies the available results in issue order, hence the latest result of an object wins, and keeps the rest pending.
+  void harvest()
+  {
+    auto kept = pending_.begin();
+    for (auto iterator = pending_.begin(); iterator != pending_.end(); ++iterator)
+    {
+      if (!iterator->query->available())
+      {
+        *kept++ = *iterator;
+        continue;
+      }
+
+      if (iterator->object < visible_.size()) // The objects may have been resized since.
+      {
+        visible_  [iterator->object] = iterator->query->result_no_wait() != 0;
+        in_flight_[iterator->object]--;
+      }
+
+      const auto latency = frame_ - iterator->frame;
+      ++statistics_.results;
+      statistics_.latency_sum     += latency;
+      statistics_.maximum_latency  = std::max(statistics_.maximum_latency, latency);
+      queries_.release(*iterator->query);
+    }
+    pending_.erase(kept, pending_.end());
+
+    statistics_.pending   = pending_.size();
+    statistics_.pool_size = queries_.size();
+  }
+
+  query_pool<target>         queries_   ;
+  std::vector<bool>          visible_   ;
+  std::vector<std::uint32_t> in_flight_ ; // Pending queries per object.
+  std::vector<pending_query> pending_   ;
+  std::size_t                frame_     = 0;
+  occlusion_query_statistics statistics_;
+};
+}
+
+#endif
@@ -0,0 +1,250 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_AUXILIARY_PIPELINE_CACHE_HPP
+#define GL_AUXILIARY_PIPELINE_CACHE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <gl/opengl.hpp>
+#include <gl/pipeline.hpp>
+#include <gl/program.hpp>
+
+namespace gl
+{
+// The separable programs bound to each stage of a pipeline. Null stages are left unused.
+struct pipeline_stages
+{
+  const program* vertex_shader                  = nullptr;
+  const program* tessellation_control_shader    = nullptr;
+  const program* tessellation_evaluation_shader = nullptr;
+  const program* geometry_shader                = nullptr;
+  const program* fragment_shader                = nullptr;
+  const program* compute_shader                 = nullptr;
+};
+
+struct pipeline_cache_statistics
+{
+  std::size_t hits      = 0;
+  std::size_t misses    = 0;
+  std::size_t evictions = 0;
+};
+
+// Returns validated program pipeline objects keyed by their stage programs. Each combination is created, validated and checked
+// for interface compatibility (outputs of each stage against the inputs of the next, by location or name and type) once.
+// Combinations with a non-separable program or mismatching interfaces are cached as well and keep returning nullptr. Combinations
+// which failed validation are cached along with their pipeline object and return nullptr; as validation depends on the current
+// state (e.g. texture unit assignments), later requests rerun only the validation of the cached object until it succeeds. The
+// least recently used entries are trimmed beyond capacity.
+class pipeline_cache
+{
+public:
+  explicit pipeline_cache  (const std::size_t capacity = 256) : capacity_(capacity)
+  {
+
+  }
+  pipeline_cache           (const pipeline_cache&  that) = delete;
+  pipeline_cache           (      pipeline_cache&& temp) = default;
+  virtual ~pipeline_cache  ()                            = default;
+  pipeline_cache& operator=(const pipeline_cache&  that) = delete;
+  pipeline_cache& operator=(      pipeline_cache&& temp) = default;
+
+  [[nodiscard]]
+  std::shared_ptr<gl::pipeline> pipeline(const pipeline_stages& stages)
+  {
+    const auto key      = make_key(stages);
+    auto       iterator = entries_.find(key);
+    if (iterator != entries_.end())
+    {
+      ++statistics_.hits;
+      auto& value = iterator->second;
+      usage_.splice(usage_.begin(), usage_, value.usage);
+      if (value.pipeline && !value.validated)
+        value.validated = value.pipeline->validate();
+      return value.validated ? value.pipeline : nullptr;
+    }
+
+    ++statistics_.misses;
+    auto       result    = create(stages);
+    const auto validated = result && result->validate();
+    usage_  .push_front(key);
+    entries_.emplace   (key, entry {result, validated, usage_.begin()});
+    trim(capacity_);
+    return validated ? result : nullptr;
+  }
+
+  // Removes all combinations which contain the program. Must be called before a cached program is destroyed, as its name may be reused.
+  void erase(const program& program)
+  {
+    for (auto iterator = entries_.begin(); iterator != entries_.end();)
+    {
+      if (std::find(iterator->first.begin(), iterator->first.end(), program.id()) != iterator->first.end())
+      {
+        usage_.erase(iterator->second.usage);
+        iterator = entries_.erase(iterator);
+      }
+      else
+        ++iterator;
+    }
+  }
+  void trim (const std::size_t size)
+  {
+    while (entries_.size() > size)
+    {
+      entries_.erase(usage_.back());
+      usage_  .pop_back();
+      ++statistics_.evictions;
+    }
+  }
+  void clear()
+  {
+    entries_.clear();
+    usage_  .clear();
+  }
+
+  void        set_capacity(const std::size_t capacity)
+  {
+    capacity_ = capacity;
+    trim(capacity_);
+  }
+  [[nodiscard]]
+  std::size_t capacity    () const
+  {
+    return capacity_;
+  }
+  [[nodiscard]]
+  std::size_t size        () const
+  {
+    return entries_.size();
+  }
+
+  [[nodiscard]]
+  const pipeline_cache_statistics& statistics() const
+  {
+    return statistics_;
+  }
+
+protected:
+  using stage_ids = std::array<GLuint, 6>;
+
+  struct stage_ids_hash
+  {
+    std::size_t operator()(const stage_ids& value) const
+    {
+      std::size_t result = 0;
+      for (const auto id : value)
+        result ^= std::hash<GLuint>()(id) + 0x9e3779b9 + (result << 6) + (result >> 2);
+      return result;
+    }
+  };
+  struct entry
+  {
+    std::shared_ptr<gl::pipeline>  pipeline ; // Null if a program is not separable or the interfaces mismatch.
+    bool                           validated;
+    std::list<stage_ids>::iterator usage    ;
+  };
+
+  static stage_ids make_key(const pipeline_stages& stages)
+  {
+    const auto id = [ ] (const program* program) { return program != nullptr ? program->id() : 0; };
+    return stage_ids
+    {
+      id(stages.vertex_shader),
+      id(stages.tessellation_control_shader),
+      id(stages.tessellation_evaluation_shader),
+      id(stages.geometry_shader),
+      id(stages.fragment_shader),
+      id(stages.compute_shader)
+    };
+  }
+
+  // Returns nullptr if a program is not separable or the interfaces mismatch. The result is not validated.
+  static std::shared_ptr<gl::pipeline> create(const pipeline_stages& stages)
+  {
+    const std::array<std::pair<const program*, GLbitfield>, 6> bindings
+    {{
+      {stages.vertex_shader                 , GL_VERTEX_SHADER_BIT         },
+      {stages.tessellation_control_shader   , GL_TESS_CONTROL_SHADER_BIT   },
+      {stages.tessellation_evaluation_shader, GL_TESS_EVALUATION_SHADER_BIT},
+      {stages.geometry_shader               , GL_GEOMETRY_SHADER_BIT       },
+      {stages.fragment_shader               , GL_FRAGMENT_SHADER_BIT       },
+      {stages.compute_shader                , GL_COMPUTE_SHADER_BIT        }
+    }};
+
+    auto result = std::make_shared<gl::pipeline>();
+    const program* producer = nullptr;
+    for (const auto& [program, stage] : bindings)
+    {
+      if (program == nullptr)
+        continue;
+      if (!program->is_separable())
+        return nullptr;
+      result->use_program_stages(stage, *program);
+
+      if (stage == GL_COMPUTE_SHADER_BIT)
+        continue;
+      if (producer != nullptr && producer != program && !interfaces_match(*producer, *program))
+        return nullptr;
+      producer = program;
+    }
+    return result;
+  }
+
+  // Every user-defined input of the consumer must be written by the producer with the same type.
+  static bool interfaces_match(const program& producer, const program& consumer)
+  {
+    const std::vector<GLenum> properties {GL_LOCATION, GL_TYPE};
+
+    struct variable
+    {
+      std::string name    ;
+      GLint       location;
+      GLint       type    ;
+    };
+    const auto variables = [&] (const program& program, const GLenum interface)
+    {
+      std::vector<variable> result;
+      const auto count = program.interface_active_resources(interface);
+      for (auto i = 0; i < count; ++i)
+      {
+        auto name = program.resource_name(interface, static_cast<GLuint>(i));
+        if (name.compare(0, 3, "gl_") == 0)
+          continue;
+        const auto values = program.resource_parameters(interface, static_cast<GLuint>(i), properties);
+        result.push_back(variable {std::move(name), values[0], values[1]});
+      }
+      return result;
+    };
+
+    const auto outputs = variables(producer, GL_PROGRAM_OUTPUT);
+    for (const auto& input : variables(consumer, GL_PROGRAM_INPUT))
+    {
+      const auto match = std::find_if(outputs.begin(), outputs.end(), [&] (const variable& output)
+      {
+        return input.location != -1 ? output.location == input.location : output.name == input.name;
+      });
+      if (match == outputs.end() || match->type != input.type)
+        return false;
+    }
+    return true;
+  }
+
+  std::size_t                                           capacity_  ;
+  std::unordered_map<stage_ids, entry, stage_ids_hash>  entries_   ;
+  std::list<stage_ids>                                  usage_     ;
+  pipeline_cache_statistics                             statistics_;
+};
+}
+
+#endif
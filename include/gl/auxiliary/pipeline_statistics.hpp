@@ -0,0 +1,296 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_AUXILIARY_PIPELINE_STATISTICS_HPP
+#define GL_AUXILIARY_PIPELINE_STATISTICS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <gl/opengl.hpp>
+#include <gl/query.hpp>
+
+namespace gl
+{
+enum pipeline_statistic : std::uint32_t
+{
+  vertices_submitted_bit                  = 1u << 0 ,
+  primitives_submitted_bit                = 1u << 1 ,
+  vertex_shader_invocations_bit           = 1u << 2 ,
+  tessellation_control_shader_patches_bit = 1u << 3 ,
+  tessellation_evaluation_invocations_bit = 1u << 4 ,
+  geometry_shader_invocations_bit         = 1u << 5 ,
+  geometry_shader_primitives_emitted_bit  = 1u << 6 ,
+  fragment_shader_invocations_bit         = 1u << 7 ,
+  compute_shader_invocations_bit          = 1u << 8 ,
+  clipping_input_primitives_bit           = 1u << 9 ,
+  clipping_output_primitives_bit          = 1u << 10,
+  primitives_generated_bit                = 1u << 11,
+  all_pipeline_statistics_bits            = (1u << 12) - 1
+};
+
+// The statistics of a pass. Statistics which were not collected are zero.
+struct pipeline_statistics
+{
+  [[nodiscard]]
+  double overdraw             () const // Fragment shader invocations per pixel of the pass.
+  {
+    return pixels > 0 ? static_cast<double>(fragment_shader_invocations) / static_cast<double>(pixels) : 0.0;
+  }
+  [[nodiscard]]
+  double culling_efficiency   () const // Fraction of the primitives entering clipping which were clipped or culled.
+  {
+    return clipping_input_primitives > 0 ? 1.0 - static_cast<double>(clipping_output_primitives) / static_cast<double>(clipping_input_primitives) : 0.0;
+  }
+  [[nodiscard]]
+  double vertex_shading_ratio () const // Vertex shader invocations per submitted vertex, below 1 with post-transform cache hits.
+  {
+    return vertices_submitted > 0 ? static_cast<double>(vertex_shader_invocations) / static_cast<double>(vertices_submitted) : 0.0;
+  }
+
+  std::string   pass                                ;
+  std::size_t   frame                               = 0;
+  std::uint32_t collected                           = 0; // pipeline_statistic bits.
+  GLuint64      pixels                              = 0; // As given to the scope, e.g. the viewport area.
+  GLuint64      vertices_submitted                  = 0;
+  GLuint64      primitives_submitted                = 0;
+  GLuint64      vertex_shader_invocations           = 0;
+  GLuint64      tessellation_control_shader_patches = 0;
+  GLuint64      tessellation_evaluation_invocations = 0;
+  GLuint64      geometry_shader_invocations         = 0;
+  GLuint64      geometry_shader_primitives_emitted  = 0;
+  GLuint64      fragment_shader_invocations         = 0;
+  GLuint64      compute_shader_invocations          = 0;
+  GLuint64      clipping_input_primitives           = 0;
+  GLuint64      clipping_output_primitives          = 0;
+  GLuint64      primitives_generated                = 0;
+};
+
+// Collects pipeline statistics queries per pass. Passes are measured with pipeline_stats_scope; the queries are drawn from a
+// query_pool per target, and end_frame() harvests the frames whose queries are all available, without waiting.
+// Queries of the same target may not nest, hence neither may pipeline_stats_scopes.
+class pipeline_statistics_collector
+{
+public:
+  explicit pipeline_statistics_collector  (const std::uint32_t statistics = all_pipeline_statistics_bits) : statistics_(statistics)
+  {
+
+  }
+  pipeline_statistics_collector           (const pipeline_statistics_collector&  that) = delete;
+  pipeline_statistics_collector           (      pipeline_statistics_collector&& temp) = default;
+  virtual ~pipeline_statistics_collector  ()                                            = default;
+  pipeline_statistics_collector& operator=(const pipeline_statistics_collector&  that) = delete;
+  pipeline_statistics_collector& operator=(      pipeline_statistics_collector&& temp) = default;
+
+  void begin_pass(const std::string& pass, const GLuint64 pixels = 0)
+  {
+    begin_pass(pass, statistics_, pixels);
+  }
+  void begin_pass(const std::string& pass, const std::uint32_t statistics, const GLuint64 pixels)
+  {
+    pending_pass value;
+    value.result.pass      = pass;
+    value.result.collected = statistics & all_pipeline_statistics_bits;
+    value.result.pixels    = pixels;
+    for_each_target([&] (auto index)
+    {
+      constexpr auto i = decltype(index)::value;
+      if (!(value.result.collected & (1u << i)))
+        return;
+      const auto& query = std::get<i>(pools_).acquire();
+      std::get<i>(value.queries) = &query;
+      query.begin();
+    });
+    current_.passes.push_back(std::move(value));
+  }
+  void end_pass  ()
+  {
+    if (current_.passes.empty())
+      return;
+    const auto& value = current_.passes.back();
+    for_each_target([&] (auto index)
+    {
+      constexpr auto i = decltype(index)::value;
+      if (value.result.collected & (1u << i))
+        std::get<i>(value.queries)->end();
+    });
+  }
+  // Ends the frame and harvests the frames whose queries are available.
+  void end_frame ()
+  {
+    current_.index = frames_++;
+    pending_.push_back(std::move(current_));
+    current_ = pending_frame();
+
+    while (!pending_.empty() && harvest(pending_.front()))
+      pending_.pop_front();
+  }
+
+  // The passes of the last harvested frame, in the order they were measured.
+  [[nodiscard]]
+  const std::vector<pipeline_statistics>& frame() const
+  {
+    return frame_;
+  }
+  // The last harvested frame as comma separated values with a header line.
+  [[nodiscard]]
+  std::string                             csv  () const
+  {
+    std::ostringstream stream;
+    stream << "frame,pass,pixels,vertices_submitted,primitives_submitted,vertex_shader_invocations,tessellation_control_shader_patches,"
+              "tessellation_evaluation_invocations,geometry_shader_invocations,geometry_shader_primitives_emitted,fragment_shader_invocations,"
+              "compute_shader_invocations,clipping_input_primitives,clipping_output_primitives,primitives_generated,overdraw,culling_efficiency,"
+              "vertex_shading_ratio\n";
+    for (const auto& value : frame_)
+      stream << value.frame << "," << value.pass << "," << value.pixels << "," << value.vertices_submitted << "," << value.primitives_submitted << ","
+             << value.vertex_shader_invocations << "," << value.tessellation_control_shader_patches << "," << value.tessellation_evaluation_invocations << ","
+             << value.geometry_shader_invocations << "," << value.geometry_shader_primitives_emitted << "," << value.fragment_shader_invocations << ","
+             << value.compute_shader_invocations << "," << value.clipping_input_primitives << "," << value.clipping_output_primitives << ","
+             << value.primitives_generated << "," << value.overdraw() << "," << value.culling_efficiency() << "," << value.vertex_shading_ratio() << "\n";
+    return stream.str();
+  }
+
+  void          set_statistics(const std::uint32_t statistics)
+  {
+    statistics_ = statistics;
+  }
+  [[nodiscard]]
+  std::uint32_t statistics    () const
+  {
+    return statistics_;
+  }
+
+protected:
+  static constexpr std::array<GLenum, 12> targets
+  {
+    GL_VERTICES_SUBMITTED,
+    GL_PRIMITIVES_SUBMITTED,
+    GL_VERTEX_SHADER_INVOCATIONS,
+    GL_TESS_CONTROL_SHADER_PATCHES,
+    GL_TESS_EVALUATION_SHADER_INVOCATIONS,
+    GL_GEOMETRY_SHADER_INVOCATIONS,
+    GL_GEOMETRY_SHADER_PRIMITIVES_EMITTED,
+    GL_FRAGMENT_SHADER_INVOCATIONS,
+    GL_COMPUTE_SHADER_INVOCATIONS,
+    GL_CLIPPING_INPUT_PRIMITIVES,
+    GL_CLIPPING_OUTPUT_PRIMITIVES,
+    GL_PRIMITIVES_GENERATED
+  };
+
+  template<std::size_t... indices>
+  static auto pools_of  (std::index_sequence<indices...>) -> std::tuple<query_pool<targets[indices]>...>;
+  template<std::size_t... indices>
+  static auto queries_of(std::index_sequence<indices...>) -> std::tuple<const query<targets[indices]>*...>;
+  using pools_type   = decltype(pools_of  (std::make_index_sequence<targets.size()>()));
+  using queries_type = decltype(queries_of(std::make_index_sequence<targets.size()>()));
+
+  // Calls function(std::integral_constant<std::size_t, i>) for the index of each target.
+  template<typename function_type>
+  static void for_each_target(function_type&& function)
+  {
+    for_each_target(function, std::make_index_sequence<targets.size()>());
+  }
+  template<typename function_type, std::size_t... indices>
+  static void for_each_target(function_type&  function, std::index_sequence<indices...>)
+  {
+    (function(std::integral_constant<std::size_t, indices>()), ...);
+  }
+
+  struct pending_pass
+  {
+    pipeline_statistics       result ;
+    queries_type              queries{};
+  };
+  struct pending_frame
+  {
+    std::size_t               index  = 0;
+    std::vector<pending_pass> passes ;
+  };
+
+  // Returns false, leaving the frame pending, if any of its queries is not yet available.
+  bool harvest(pending_frame& pending)
+  {
+    for (const auto& value : pending.passes)
+    {
+      auto available = true;
+      for_each_target([&] (auto index)
+      {
+        constexpr auto i = decltype(index)::value;
+        if (available && (value.result.collected & (1u << i)))
+          available = std::get<i>(value.queries)->available();
+      });
+      if (!available)
+        return false;
+    }
+
+    frame_.clear();
+    for (auto& value : pending.passes)
+    {
+      auto&     result = value.result;
+      GLuint64* fields[] =
+      {
+        &result.vertices_submitted, &result.primitives_submitted, &result.vertex_shader_invocations, &result.tessellation_control_shader_patches,
+        &result.tessellation_evaluation_invocations, &result.geometry_shader_invocations, &result.geometry_shader_primitives_emitted,
+        &result.fragment_shader_invocations, &result.compute_shader_invocations, &result.clipping_input_primitives,
+        &result.clipping_output_primitives, &result.primitives_generated
+      };
+      result.frame = pending.index;
+      for_each_target([&] (auto index)
+      {
+        constexpr auto i = decltype(index)::value;
+        if (!(result.collected & (1u << i)))
+          return;
+        const auto& query = *std::get<i>(value.queries);
+        *fields[i] = query.result_no_wait();
+        std::get<i>(pools_).release(query);
+      });
+      frame_.push_back(std::move(result));
+    }
+    return true;
+  }
+
+  std::uint32_t                           statistics_;
+  pools_type                              pools_     ;
+  pending_frame                           current_   ;
+  std::deque<pending_frame>               pending_   ;
+  std::size_t                             frames_    = 0;
+  std::vector<pipeline_statistics>        frame_     ;
+};
+
+// Measures the pipeline statistics of a pass (all statistics enabled in the collector, or the given subset) for its lifetime.
+class pipeline_stats_scope
+{
+public:
+  pipeline_stats_scope           (pipeline_statistics_collector& collector, const std::string& pass, const GLuint64 pixels = 0) : collector_(collector)
+  {
+    collector_.begin_pass(pass, pixels);
+  }
+  pipeline_stats_scope           (pipeline_statistics_collector& collector, const std::string& pass, const std::uint32_t statistics, const GLuint64 pixels) : collector_(collector)
+  {
+    collector_.begin_pass(pass, statistics, pixels);
+  }
+  pipeline_stats_scope           (const pipeline_stats_scope&  that) = delete;
+  pipeline_stats_scope           (      pipeline_stats_scope&& temp) = delete;
+  virtual ~pipeline_stats_scope  ()
+  {
+    collector_.end_pass();
+  }
+  pipeline_stats_scope& operator=(const pipeline_stats_scope&  that) = delete;
+  pipeline_stats_scope& operator=(      pipeline_stats_scope&& temp) = delete;
+
+protected:
+  pipeline_statistics_collector& collector_;
+};
+}
+
+#endif
@@ -0,0 +1,160 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_AUXILIARY_QUERY_ARGUMENTS_HPP
+#define GL_AUXILIARY_QUERY_ARGUMENTS_HPP
+
+#include <cstddef>
+#include <string>
+
+#include <gl/opengl.hpp>
+#include <gl/buffer.hpp>
+#include <gl/compute.hpp>
+#include <gl/draw_commands.hpp>
+#include <gl/program.hpp>
+#include <gl/shader.hpp>
+
+namespace gl
+{
+// Turns query results written to a buffer with query::result_to_buffer (64-bit) into indirect draw or dispatch arguments with
+// a compute pass, so that neither the results nor the arguments go through the client. Counts beyond 2^32 - 1 saturate.
+// Result offsets must be multiples of 8 bytes, command offsets multiples of 4. The buffers are bound to shader storage
+// bindings [0, 3) during each call, which ends with a command barrier, hence the arguments are ready for the next draw or dispatch.
+class query_argument_builder
+{
+public:
+  query_argument_builder           ()
+  {
+    shader shader(GL_COMPUTE_SHADER);
+    shader.set_source(source());
+    if (shader.compile())
+    {
+      program_.attach_shader(shader);
+      valid_ = program_.link();
+      program_.detach_shader(shader);
+    }
+  }
+  query_argument_builder           (const query_argument_builder&  that) = delete;
+  query_argument_builder           (      query_argument_builder&& temp) = default;
+  virtual ~query_argument_builder  ()                                    = default;
+  query_argument_builder& operator=(const query_argument_builder&  that) = delete;
+  query_argument_builder& operator=(      query_argument_builder&& temp) = default;
+
+  // Copies count draw_elements_indirect_commands from the templates, zeroing the instance count of each command whose occlusion
+  // result (samples or any samples passed, one per command) is zero.
+  void occlusion_to_draw_elements(const gl::buffer& results, const GLintptr results_offset, const gl::buffer& templates, const GLintptr templates_offset, const gl::buffer& commands, const GLintptr commands_offset, const GLuint count)
+  {
+    run(mode::occlusion, results, results_offset, &templates, templates_offset, commands, commands_offset, count, 0);
+  }
+  // Writes count draw_arrays_indirect_commands drawing vertices_per_primitive vertices for each primitive counted by the results
+  // (e.g. primitives generated or transform feedback primitives written), with one instance from the first vertex.
+  void count_to_draw_arrays      (const gl::buffer& results, const GLintptr results_offset, const gl::buffer& commands, const GLintptr commands_offset, const GLuint count = 1, const GLuint vertices_per_primitive = 3)
+  {
+    run(mode::draw_arrays, results, results_offset, nullptr, 0, commands, commands_offset, count, vertices_per_primitive);
+  }
+  // Writes count dispatch_indirect_commands of ceil(result / items_per_group) work groups along x.
+  void count_to_dispatch         (const gl::buffer& results, const GLintptr results_offset, const gl::buffer& commands, const GLintptr commands_offset, const GLuint count = 1, const GLuint items_per_group = 64)
+  {
+    run(mode::dispatch, results, results_offset, nullptr, 0, commands, commands_offset, count, items_per_group);
+  }
+
+  [[nodiscard]]
+  bool               is_valid() const
+  {
+    return valid_;
+  }
+  [[nodiscard]]
+  const gl::program& program () const
+  {
+    return program_;
+  }
+
+protected:
+  enum class mode : GLuint
+  {
+    occlusion   = 0,
+    draw_arrays = 1,
+    dispatch    = 2
+  };
+
+  static std::string source()
+  {
+    return R"(#version 460
+layout(local_size_x = 64) in;
+
+layout(std430, binding = 0) readonly  buffer results_buffer   { uvec2 results  []; };
+layout(std430, binding = 1) readonly  buffer templates_buffer { uint  templates[]; };
+layout(std430, binding = 2) writeonly buffer commands_buffer  { uint  commands []; };
+
+layout(location = 0) uniform uint mode;
+layout(location = 1) uniform uint count;
+layout(location = 2) uniform uint results_offset;   // In results.
+layout(location = 3) uniform uint templates_offset; // In uints.
+layout(location = 4) uniform uint commands_offset;  // In uints.
+layout(location = 5) uniform uint parameter;
+
+void main()
+{
+  const uint index = gl_GlobalInvocationID.x;
+  if (index >= count)
+    return;
+
+  const uvec2 result = results[results_offset + index];
+  const uint  value  = result.y != 0u ? 0xFFFFFFFFu : result.x;
+  if (mode == 0u)
+  {
+    const uint source      = templates_offset + 5u * index;
+    const uint destination = commands_offset  + 5u * index;
+    for (uint i = 0u; i < 5u; ++i)
+      commands[destination + i] = templates[source + i];
+    if (value == 0u)
+      commands[destination + 1u] = 0u;
+  }
+  else if (mode == 1u)
+  {
+    const uint destination = commands_offset + 4u * index;
+    commands[destination     ] = value > 0xFFFFFFFFu / parameter ? 0xFFFFFFFFu : value * parameter;
+    commands[destination + 1u] = 1u;
+    commands[destination + 2u] = 0u;
+    commands[destination + 3u] = 0u;
+  }
+  else
+  {
+    const uint destination = commands_offset + 3u * index;
+    commands[destination     ] = value / parameter + (value % parameter != 0u ? 1u : 0u);
+    commands[destination + 1u] = 1u;
+    commands[destination + 2u] = 1u;
+  }
+}
+)";
+  }
+
+  void run(const mode mode, const gl::buffer& results, const GLintptr results_offset, const gl::buffer* templates, const GLintptr templates_offset, const gl::buffer& commands, const GLintptr commands_offset, const GLuint count, const GLuint parameter)
+  {
+    if (count == 0)
+      return;
+
+    results .bind_base(GL_SHADER_STORAGE_BUFFER, 0);
+    (templates != nullptr ? *templates : commands).bind_base(GL_SHADER_STORAGE_BUFFER, 1);
+    commands.bind_base(GL_SHADER_STORAGE_BUFFER, 2);
+
+    program_.use();
+    program_.set_uniform_1ui(0, static_cast<GLuint>(mode));
+    program_.set_uniform_1ui(1, count);
+    program_.set_uniform_1ui(2, static_cast<GLuint>(results_offset   / sizeof(GLuint64)));
+    program_.set_uniform_1ui(3, static_cast<GLuint>(templates_offset / sizeof(GLuint  )));
+    program_.set_uniform_1ui(4, static_cast<GLuint>(commands_offset  / sizeof(GLuint  )));
+    program_.set_uniform_1ui(5, parameter > 0 ? parameter : 1);
+    dispatch_compute((count + 63) / 64, 1, 1);
+
+    memory_barrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+  }
+
+  gl::program program_;
+  bool        valid_   = false;
+};
+}
+
+#endif
@@ -0,0 +1,379 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_AUXILIARY_RENDER_QUEUE_HPP
+#define GL_AUXILIARY_RENDER_QUEUE_HPP
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gl/opengl.hpp>
+#include <gl/draw_commands.hpp>
+#include <gl/program.hpp>
+#include <gl/render_state.hpp>
+#include <gl/texture.hpp>
+#include <gl/vertex_array.hpp>
+
+namespace gl
+{
+// A single draw and the state it requires. Null program, vertex array and render state pointers leave the current ones in place.
+// A zero index_type draws arrays (offset is the first vertex), otherwise elements (offset is the byte offset into the indices).
+struct draw_packet
+{
+  std::uint32_t               pass           = 0;
+  const gl::program*          program        = nullptr;
+  const gl::vertex_array*     vertex_array   = nullptr;
+  const render_state*         state          = nullptr;
+  std::uint32_t               material       = 0;
+  GLfloat                     depth          = 0.0f;   // View depth, quantized over the depth range of the sort_key_layout.
+
+  std::array<texture_ref, 8>  textures       {};       // Bound to units [0, texture_count).
+  GLuint                      texture_count  = 0;
+
+  GLenum                      mode           = GL_TRIANGLES;
+  GLenum                      index_type     = 0;
+  GLsizei                     count          = 0;
+  GLintptr                    offset         = 0;
+  GLsizei                     instance_count = 1;
+  GLint                       base_vertex    = 0;
+  GLuint                      base_instance  = 0;
+
+  void                      (*setup)(const draw_packet&, const void*) = nullptr; // Called before the draw, e.g. to set uniforms.
+  const void*                 user_data      = nullptr;
+};
+
+enum class sort_key_field
+{
+  pass,
+  program,
+  render_state,
+  material,
+  depth
+};
+
+// The fields packed into the 64-bit sort key, most significant first, with their widths in bits (at most 64 in total).
+// Program ids and materials are truncated to their low bits, render state hashes to their high bits.
+struct sort_key_layout
+{
+  std::vector<std::pair<sort_key_field, std::uint32_t>> fields
+  {
+    {sort_key_field::pass        ,  4},
+    {sort_key_field::program     , 12},
+    {sort_key_field::render_state, 16},
+    {sort_key_field::material    , 16},
+    {sort_key_field::depth       , 16}
+  };
+  std::array<GLfloat, 2> depth_range      {0.0f, 1000.0f};
+  bool                   depth_descending = false; // Back to front, e.g. for transparent passes.
+};
+
+// Consecutive packets which differ in each kind of state.
+struct render_queue_state_changes
+{
+  std::size_t programs      = 0;
+  std::size_t vertex_arrays = 0;
+  std::size_t render_states = 0;
+  std::size_t textures      = 0;
+};
+struct render_queue_statistics
+{
+  std::size_t                packets  = 0;
+  render_queue_state_changes unsorted ; // In submission order.
+  render_queue_state_changes sorted   ;
+};
+
+// Collects draw packets with sort keys, sorts them with an LSD radix sort (spread over threads spawned once per sort() for large
+// queues) and executes them in order, skipping program, vertex array, render state and texture binds that match the previous
+// packet.
+class render_queue
+{
+public:
+  explicit render_queue  (sort_key_layout layout = sort_key_layout(), const std::size_t parallel_threshold = 65536)
+  : layout_(std::move(layout)), parallel_threshold_(parallel_threshold)
+  {
+
+  }
+  render_queue           (const render_queue&  that) = default;
+  render_queue           (      render_queue&& temp) = default;
+  virtual ~render_queue  ()                          = default;
+  render_queue& operator=(const render_queue&  that) = default;
+  render_queue& operator=(      render_queue&& temp) = default;
+
+  void push   (const draw_packet& packet)
+  {
+    entries_.push_back(entry {key(packet), static_cast<std::uint32_t>(packets_.size())});
+    packets_.push_back(packet);
+  }
+  void sort   ()
+  {
+    statistics_.packets  = packets_.size();
+    statistics_.unsorted = state_changes();
+
+    std::uint32_t key_bits = 0;
+    for (const auto& field : layout_.fields)
+      key_bits += field.second;
+
+    const auto thread_count = entries_.size() >= parallel_threshold_ ? std::max(1u, std::thread::hardware_concurrency()) : 1u;
+    scratch_   .resize(entries_.size());
+    histograms_.resize(thread_count);
+    radix_sort(std::min(key_bits, 64u), thread_count);
+
+    statistics_.sorted   = state_changes();
+  }
+  void execute() const
+  {
+    const program*      last_program      = nullptr;
+    const vertex_array* last_vertex_array = nullptr;
+    const render_state* last_state        = nullptr;
+    const draw_packet*  last_packet       = nullptr;
+    for (const auto& entry : entries_)
+    {
+      const auto& packet = packets_[entry.index];
+      if (packet.program      != nullptr && packet.program      != last_program)
+      {
+        packet.program->use();
+        last_program = packet.program;
+      }
+      if (packet.vertex_array != nullptr && packet.vertex_array != last_vertex_array)
+      {
+        packet.vertex_array->bind();
+        last_vertex_array = packet.vertex_array;
+      }
+      if (packet.state        != nullptr && packet.state        != last_state)
+      {
+        render_state::apply(*packet.state);
+        last_state = packet.state;
+      }
+      if (packet.texture_count > 0 && (last_packet == nullptr || !same_textures(packet, *last_packet)))
+        bind_textures(0, span<const texture_ref>(packet.textures.data(), std::min<std::size_t>(packet.texture_count, packet.textures.size())));
+      if (packet.setup != nullptr)
+        packet.setup(packet, packet.user_data);
+
+      if (packet.index_type == 0)
+        draw_arrays_instanced_base_instance              (packet.mode, static_cast<GLint>(packet.offset), packet.count, packet.instance_count, packet.base_instance);
+      else
+        draw_elements_instanced_base_vertex_base_instance(packet.mode, packet.count, packet.index_type, reinterpret_cast<const void*>(packet.offset), packet.instance_count, packet.base_vertex, packet.base_instance);
+      last_packet = &packet;
+    }
+  }
+  // Keeps the capacity, hence a queue reused every frame stops allocating once it has reached its peak size.
+  void clear  ()
+  {
+    packets_.clear();
+    entries_.clear();
+  }
+
+  [[nodiscard]]
+  std::uint64_t key(const draw_packet& packet) const
+  {
+    std::uint32_t key_bits = 0;
+    for (const auto& field : layout_.fields)
+      key_bits += field.second;
+
+    std::uint64_t result = 0;
+    std::uint32_t shift  = std::min(key_bits, 64u);
+    for (const auto& [field, bits] : layout_.fields)
+    {
+      if (bits == 0 || bits > shift)
+        break;
+      shift -= bits;
+      const auto mask = bits < 64 ? (std::uint64_t(1) << bits) - 1 : ~std::uint64_t(0);
+
+      std::uint64_t value = 0;
+      switch (field)
+      {
+      case sort_key_field::pass        : value = packet.pass; break;
+      case sort_key_field::program     : value = packet.program != nullptr ? packet.program->id() : 0; break;
+      case sort_key_field::render_state: value = packet.state   != nullptr ? packet.state->hash() >> (64 - bits) : 0; break;
+      case sort_key_field::material    : value = packet.material; break;
+      case sort_key_field::depth       :
+      {
+        const auto range      = layout_.depth_range[1] - layout_.depth_range[0];
+        auto       normalized = range > 0.0f ? std::clamp((packet.depth - layout_.depth_range[0]) / range, 0.0f, 1.0f) : 0.0f;
+        if (layout_.depth_descending)
+          normalized = 1.0f - normalized;
+        value = static_cast<std::uint64_t>(static_cast<double>(normalized) * static_cast<double>(mask));
+        break;
+      }
+      }
+      result |= (value & mask) << shift;
+    }
+    return result;
+  }
+
+  [[nodiscard]]
+  const std::vector<draw_packet>& packets   () const
+  {
+    return packets_;
+  }
+  [[nodiscard]]
+  std::size_t                     size      () const
+  {
+    return packets_.size();
+  }
+  [[nodiscard]]
+  const sort_key_layout&          layout    () const
+  {
+    return layout_;
+  }
+  [[nodiscard]]
+  const render_queue_statistics&  statistics() const
+  {
+    return statistics_;
+  }
+
+protected:
+  struct entry
+  {
+    std::uint64_t key  ;
+    std::uint32_t index;
+  };
+
+  static bool same_textures(const draw_packet& lhs, const draw_packet& rhs)
+  {
+    if (lhs.texture_count != rhs.texture_count)
+      return false;
+    for (std::size_t i = 0; i < std::min<std::size_t>(lhs.texture_count, lhs.textures.size()); ++i)
+      if (lhs.textures[i].id() != rhs.textures[i].id())
+        return false;
+    return true;
+  }
+
+  // Blocks each of count threads until all of them have arrived, reusable across phases.
+  class thread_barrier
+  {
+  public:
+    explicit thread_barrier(const std::size_t count) : count_(count)
+    {
+
+    }
+
+    void arrive_and_wait()
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      const auto generation = generation_;
+      if (++arrived_ == count_)
+      {
+        arrived_ = 0;
+        ++generation_;
+        condition_.notify_all();
+        return;
+      }
+      condition_.wait(lock, [&] { return generation != generation_; });
+    }
+
+  protected:
+    std::mutex              mutex_      ;
+    std::condition_variable condition_  ;
+    std::size_t             count_      ;
+    std::size_t             arrived_    = 0;
+    std::size_t             generation_ = 0;
+  };
+
+  // An LSD radix sort with a stable counting sort per 8 bits of the key. The threads are spawned once and run every pass, each
+  // counting and scattering a contiguous chunk; the offsets of each chunk follow those of the preceding chunks for the same
+  // digit, which keeps the passes stable. Passes in which all keys share the digit are skipped.
+  void radix_sort(const std::uint32_t key_bits, const std::size_t thread_count)
+  {
+    const auto     size       = entries_.size();
+    const auto     chunk_size = (size + thread_count - 1) / thread_count;
+    thread_barrier barrier(thread_count);
+    bool           skip       = false;
+    std::size_t    swaps      = 0;
+
+    const auto worker = [&] (const std::size_t thread)
+    {
+      auto* source      = &entries_;
+      auto* destination = &scratch_;
+      auto& histogram   = histograms_[thread];
+      const auto begin  = std::min(size, thread * chunk_size);
+      const auto end    = std::min(size, (thread + 1) * chunk_size);
+
+      for (std::uint32_t shift = 0; shift < key_bits; shift += 8)
+      {
+        const auto digit = [shift] (const entry& value) { return static_cast<std::size_t>((value.key >> shift) & 0xFF); };
+
+        histogram.fill(0);
+        for (auto i = begin; i < end; ++i)
+          ++histogram[digit((*source)[i])];
+        barrier.arrive_and_wait();
+
+        if (thread == 0)
+        {
+          skip = false;
+          std::size_t offset = 0;
+          for (std::size_t value = 0; value < 256 && !skip; ++value)
+            for (auto& chunk_histogram : histograms_)
+            {
+              const auto count = chunk_histogram[value];
+              if (count == size)
+              {
+                skip = true;
+                break;
+              }
+              chunk_histogram[value] = offset;
+              offset                += count;
+            }
+          if (!skip)
+            ++swaps;
+        }
+        barrier.arrive_and_wait();
+        if (skip)
+          continue;
+
+        for (auto i = begin; i < end; ++i)
+          (*destination)[histogram[digit((*source)[i])]++] = (*source)[i];
+        std::swap(source, destination);
+        barrier.arrive_and_wait();
+      }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (std::size_t i = 1; i < thread_count; ++i)
+      threads.emplace_back(worker, i);
+    worker(0);
+    for (auto& thread : threads)
+      thread.join();
+
+    if (swaps % 2 == 1)
+      entries_.swap(scratch_);
+  }
+
+  [[nodiscard]]
+  render_queue_state_changes state_changes() const
+  {
+    render_queue_state_changes result;
+    const draw_packet*         last = nullptr;
+    for (const auto& entry : entries_)
+    {
+      const auto& packet = packets_[entry.index];
+      if (last == nullptr || packet.program      != last->program     ) ++result.programs;
+      if (last == nullptr || packet.vertex_array != last->vertex_array) ++result.vertex_arrays;
+      if (last == nullptr || packet.state        != last->state       ) ++result.render_states;
+      if (last == nullptr || !same_textures(packet, *last)            ) ++result.textures;
+      last = &packet;
+    }
+    return result;
+  }
+
+  sort_key_layout                          layout_            ;
+  std::size_t                              parallel_threshold_;
+  std::vector<draw_packet>                 packets_           ;
+  std::vector<entry>                       entries_           ; // Sort keys and packet indices, in execution order.
+  std::vector<entry>                       scratch_           ;
+  std::vector<std::array<std::size_t, 256>> histograms_        ;
+  render_queue_statistics                  statistics_        ;
+};
+}
+
+#endif
@@ -0,0 +1,398 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_AUXILIARY_SPIR_V_REGISTRY_HPP
+#define GL_AUXILIARY_SPIR_V_REGISTRY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#include <gl/opengl.hpp>
+#include <gl/program.hpp>
+#include <gl/shader.hpp>
+
+namespace gl
+{
+// A read-only memory mapping of a SPIR-V module on disk, identified by the hash of its contents.
+class spir_v_module
+{
+public:
+  explicit spir_v_module  (const std::string& filename)
+  {
+#ifdef _WIN32
+    file_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+      return;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0)
+      return;
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ == nullptr)
+      return;
+    data_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+    size_ = data_ != nullptr ? static_cast<std::size_t>(size.QuadPart) : 0;
+#else
+    file_ = open(filename.c_str(), O_RDONLY);
+    if (file_ == -1)
+      return;
+    struct stat status {};
+    if (fstat(file_, &status) != 0 || status.st_size == 0)
+      return;
+    auto* data = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file_, 0);
+    if (data == MAP_FAILED)
+      return;
+    data_ = data;
+    size_ = static_cast<std::size_t>(status.st_size);
+#endif
+    hash_ = hash_bytes(data_, size_);
+  }
+  spir_v_module           (const spir_v_module&  that) = delete;
+  spir_v_module           (      spir_v_module&& temp) = delete;
+  virtual ~spir_v_module  ()
+  {
+#ifdef _WIN32
+    if (data_    != nullptr)              UnmapViewOfFile(data_);
+    if (mapping_ != nullptr)              CloseHandle    (mapping_);
+    if (file_    != INVALID_HANDLE_VALUE) CloseHandle    (file_);
+#else
+    if (data_    != nullptr)              munmap         (const_cast<void*>(data_), size_);
+    if (file_    != -1)                   close          (file_);
+#endif
+  }
+  spir_v_module& operator=(const spir_v_module&  that) = delete;
+  spir_v_module& operator=(      spir_v_module&& temp) = delete;
+
+  [[nodiscard]]
+  bool          is_valid() const
+  {
+    return data_ != nullptr;
+  }
+  [[nodiscard]]
+  const void*   data    () const
+  {
+    return data_;
+  }
+  [[nodiscard]]
+  std::size_t   size    () const
+  {
+    return size_;
+  }
+  [[nodiscard]]
+  std::uint64_t hash    () const
+  {
+    return hash_;
+  }
+
+  // FNV-1a.
+  static std::uint64_t hash_bytes(const void* data, const std::size_t size, std::uint64_t seed = 14695981039346656037ull)
+  {
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+    for (std::size_t i = 0; i < size; ++i)
+      seed = (seed ^ bytes[i]) * 1099511628211ull;
+    return seed;
+  }
+
+protected:
+#ifdef _WIN32
+  HANDLE        file_    = INVALID_HANDLE_VALUE;
+  HANDLE        mapping_ = nullptr;
+#else
+  int           file_    = -1;
+#endif
+  const void*   data_    = nullptr;
+  std::size_t   size_    = 0;
+  std::uint64_t hash_    = 0;
+};
+
+// A single shader stage of a program built from a SPIR-V module.
+struct spir_v_stage
+{
+  std::shared_ptr<const spir_v_module>    module      = nullptr;
+  GLenum                                  shader_type = GL_VERTEX_SHADER;
+  std::string                             entry_point = "main";
+  std::vector<std::tuple<GLuint, GLuint>> constants   = {}; // Specialization constant index - value pairs.
+};
+
+struct spir_v_registry_statistics
+{
+  std::size_t module_loads    = 0; // Files mapped.
+  std::size_t program_hits    = 0; // Programs returned from memory.
+  std::size_t binary_hits     = 0; // Programs restored from on-disk program binaries.
+  std::size_t program_builds  = 0; // Programs specialized and linked from SPIR-V.
+};
+
+// Maps each .spv file once and shares linked programs across callers, keyed by the (module hash, shader type, entry point,
+// specialization constants) of each of their stages. If a binary cache directory is given, every specialization is additionally
+// stored as a program binary and restored from it on subsequent runs. Binary files are named by the hash of the key but carry the
+// full key and the driver identification, and are rebuilt if either differs or the driver rejects the binary.
+class spir_v_registry
+{
+public:
+  explicit spir_v_registry  (std::string binary_cache_directory = std::string()) : binary_cache_directory_(std::move(binary_cache_directory))
+  {
+
+  }
+  spir_v_registry           (const spir_v_registry&  that) = delete;
+  spir_v_registry           (      spir_v_registry&& temp) = default;
+  virtual ~spir_v_registry  ()                             = default;
+  spir_v_registry& operator=(const spir_v_registry&  that) = delete;
+  spir_v_registry& operator=(      spir_v_registry&& temp) = default;
+
+  [[nodiscard]]
+  std::shared_ptr<const spir_v_module> module (const std::string& filename)
+  {
+    auto iterator = modules_.find(filename);
+    if (iterator != modules_.end())
+      return iterator->second;
+
+    auto result = std::make_shared<const spir_v_module>(filename);
+    if (!result->is_valid())
+      return nullptr;
+    ++statistics_.module_loads;
+    modules_.emplace(filename, result);
+    return result;
+  }
+  // Returns nullptr if a stage fails to specialize or the program fails to link.
+  [[nodiscard]]
+  std::shared_ptr<gl::program>         program(const std::vector<spir_v_stage>& stages, const bool separable = false)
+  {
+    program_key key {separable, {}};
+    key.stages.reserve(stages.size());
+    for (const auto& stage : stages)
+    {
+      if (stage.module == nullptr)
+        return nullptr;
+      key.stages.push_back(stage_key {stage.module->hash(), stage.shader_type, stage.entry_point, stage.constants});
+    }
+
+    auto iterator = programs_.find(key);
+    if (iterator != programs_.end())
+    {
+      ++statistics_.program_hits;
+      return iterator->second;
+    }
+
+    auto result = std::make_shared<gl::program>();
+    result->set_separable         (separable);
+    result->set_binary_retrievable(!binary_cache_directory_.empty());
+
+    const auto filename = binary_filename(key);
+    const auto header   = filename.empty() ? std::string() : binary_header(key);
+    if (!filename.empty() && load_binary(*result, filename, header))
+      ++statistics_.binary_hits;
+    else
+    {
+      std::vector<shader> shaders;
+      shaders.reserve(stages.size());
+      for (const auto& stage : stages)
+      {
+        shaders.emplace_back(stage.shader_type);
+        shaders.back().set_binary(stage.module->data(), static_cast<GLsizei>(stage.module->size()));
+        shaders.back().specialize(stage.entry_point, stage.constants);
+        if (!shaders.back().compile_status())
+          return nullptr;
+        result->attach_shader(shaders.back());
+      }
+      if (!result->link())
+        return nullptr;
+      for (const auto& shader : shaders)
+        result->detach_shader(shader);
+
+      ++statistics_.program_builds;
+      if (!filename.empty())
+        save_binary(*result, filename, header);
+    }
+
+    programs_.emplace(std::move(key), result);
+    return result;
+  }
+
+  // Drops the registry's references. Programs and modules still held by callers stay alive.
+  void clear()
+  {
+    programs_.clear();
+    modules_ .clear();
+  }
+
+  [[nodiscard]]
+  const spir_v_registry_statistics& statistics() const
+  {
+    return statistics_;
+  }
+
+protected:
+  struct stage_key
+  {
+    std::uint64_t                           module_hash;
+    GLenum                                  shader_type;
+    std::string                             entry_point;
+    std::vector<std::tuple<GLuint, GLuint>> constants  ;
+
+    bool operator==(const stage_key& that) const
+    {
+      return module_hash == that.module_hash && shader_type == that.shader_type && entry_point == that.entry_point && constants == that.constants;
+    }
+  };
+  struct program_key
+  {
+    bool                   separable;
+    std::vector<stage_key> stages   ;
+
+    bool operator==(const program_key& that) const
+    {
+      return separable == that.separable && stages == that.stages;
+    }
+  };
+  struct program_key_hash
+  {
+    std::size_t operator()(const program_key& key) const
+    {
+      return static_cast<std::size_t>(hash(key));
+    }
+  };
+
+  static std::uint64_t hash(const program_key& key)
+  {
+    auto result = spir_v_module::hash_bytes(&key.separable, sizeof key.separable);
+    for (const auto& stage : key.stages)
+    {
+      result = spir_v_module::hash_bytes(&stage.module_hash, sizeof stage.module_hash, result);
+      result = spir_v_module::hash_bytes(&stage.shader_type, sizeof stage.shader_type, result);
+      result = spir_v_module::hash_bytes(stage.entry_point.data(), stage.entry_point.size() + 1, result);
+      for (const auto& [index, value] : stage.constants)
+      {
+        result = spir_v_module::hash_bytes(&index, sizeof index, result);
+        result = spir_v_module::hash_bytes(&value, sizeof value, result);
+      }
+    }
+    return result;
+  }
+
+  [[nodiscard]]
+  std::string binary_filename(const program_key& key) const
+  {
+    if (binary_cache_directory_.empty())
+      return std::string();
+
+    char name[17];
+    std::snprintf(name, sizeof name, "%016llx", static_cast<unsigned long long>(hash(key)));
+    return binary_cache_directory_ + "/" + name + ".bin";
+  }
+  // Identifies the contents of a binary file: the driver (vendor, renderer, version) and the full key, so that neither a hash
+  // collision nor a binary of another driver or specialization is ever loaded.
+  static std::string binary_header(const program_key& key)
+  {
+    std::string result;
+    const auto append = [&] (const void* data, const std::size_t size)
+    {
+      result.append(static_cast<const char*>(data), size);
+    };
+    for (const auto name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+    {
+      const auto* value = reinterpret_cast<const char*>(glGetString(name));
+      result += value != nullptr ? value : "";
+      result += '\n';
+    }
+
+    const auto stage_count = static_cast<std::uint32_t>(key.stages.size());
+    append(&key.separable, sizeof key.separable);
+    append(&stage_count  , sizeof stage_count  );
+    for (const auto& stage : key.stages)
+    {
+      const auto entry_point_size = static_cast<std::uint32_t>(stage.entry_point.size());
+      const auto constant_count   = static_cast<std::uint32_t>(stage.constants  .size());
+      append(&stage.module_hash       , sizeof stage.module_hash);
+      append(&stage.shader_type       , sizeof stage.shader_type);
+      append(&entry_point_size        , sizeof entry_point_size );
+      append(stage.entry_point.data() , entry_point_size        );
+      append(&constant_count          , sizeof constant_count   );
+      for (const auto& [index, value] : stage.constants)
+      {
+        append(&index, sizeof index);
+        append(&value, sizeof value);
+      }
+    }
+    return result;
+  }
+
+  // The file layout is the size of the header (std::uint32_t), the header, the binary format (GLenum) and the binary itself.
+  static bool load_binary(      gl::program& program, const std::string& filename, const std::string& header)
+  {
+    auto* file = std::fopen(filename.c_str(), "rb");
+    if (file == nullptr)
+      return false;
+
+    std::uint32_t        header_size = 0;
+    std::string          stored_header;
+    GLenum               format;
+    std::vector<GLubyte> binary;
+    auto                 valid = std::fread(&header_size, sizeof header_size, 1, file) == 1 && header_size == header.size();
+    if (valid)
+    {
+      stored_header.resize(header_size);
+      valid = std::fread(&stored_header[0], 1, header_size, file) == header_size && stored_header == header && std::fread(&format, sizeof format, 1, file) == 1;
+    }
+    if (valid)
+    {
+      const auto offset = std::ftell(file);
+      std::fseek(file, 0, SEEK_END);
+      const auto size = std::ftell(file) - offset;
+      std::fseek(file, offset, SEEK_SET);
+      binary.resize(size > 0 ? static_cast<std::size_t>(size) : 0);
+      valid = !binary.empty() && std::fread(binary.data(), 1, binary.size(), file) == binary.size();
+    }
+    std::fclose(file);
+
+    if (!valid)
+      return false;
+    program.set_program_binary(format, binary.data(), static_cast<GLsizei>(binary.size()));
+    return program.link_status();
+  }
+  static void save_binary(const gl::program& program, const std::string& filename, const std::string& header)
+  {
+    GLenum               format;
+    std::vector<GLubyte> binary(program.binary_length());
+    if (binary.empty())
+      return;
+    glGetProgramBinary(program.id(), static_cast<GLsizei>(binary.size()), nullptr, &format, binary.data());
+
+    auto* file = std::fopen(filename.c_str(), "wb");
+    if (file == nullptr)
+      return;
+    const auto header_size = static_cast<std::uint32_t>(header.size());
+    std::fwrite(&header_size , sizeof header_size, 1            , file);
+    std::fwrite(header.data(), 1                 , header.size(), file);
+    std::fwrite(&format      , sizeof format     , 1            , file);
+    std::fwrite(binary.data(), 1                 , binary.size(), file);
+    std::fclose(file);
+  }
+
+  std::string                                                                    binary_cache_directory_;
+  std::unordered_map<std::string, std::shared_ptr<const spir_v_module>>          modules_               ;
+  std::unordered_map<program_key, std::shared_ptr<gl::program>, program_key_hash> programs_              ;
+  spir_v_registry_statistics                                                     statistics_            ;
+};
+}
+
+#endif
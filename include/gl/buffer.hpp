@@ -6,9 +6,14 @@
 #ifndef GL_BUFFER_HPP
 #define GL_BUFFER_HPP
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <vector>
 
 #include <gl/opengl.hpp>
+#include <gl/state_cache.hpp>
+#include <gl/span.hpp>
 
 #ifdef GL_CUDA_INTEROP_SUPPORT
   #include <cuda_gl_interop.h>
@@ -51,7 +56,10 @@ public:
   virtual ~buffer  ()
   {
     if (managed_ && id_ != invalid_id)
+    {
+      forget_object(GL_BUFFER, id_);
       glDeleteBuffers(1, &id_);
+    }
   }
   buffer& operator=(const buffer&  that)
   {
@@ -66,7 +74,10 @@ public:
     if (this != &temp)
     {
       if (managed_ && id_ != invalid_id)
+      {
+        forget_object(GL_BUFFER, id_);
         glDeleteBuffers(1, &id_);
+      }
   
       id_       = temp.id_;
       managed_  = temp.managed_;
@@ -94,19 +105,23 @@ public:
   }
   void        bind_range  (const GLenum target, const GLuint index, const GLintptr offset, const GLsizeiptr size) const
   {
-    glBindBufferRange(target, index, id_, offset, size);
+    if (buffer_binding_changed(target, index, id_, offset, size))
+      glBindBufferRange(target, index, id_, offset, size);
   }
   static void unbind_range(const GLenum target, const GLuint index, const GLintptr offset, const GLsizeiptr size)
   {
-    glBindBufferRange(target, index, 0, offset, size);
+    if (buffer_binding_changed(target, index, 0))
+      glBindBufferRange(target, index, 0, offset, size);
   }
   void        bind_base   (const GLenum target, const GLuint index) const
   {
-    glBindBufferBase(target, index, id_);
+    if (buffer_binding_changed(target, index, id_))
+      glBindBufferBase(target, index, id_);
   }
   static void unbind_base (const GLenum target, const GLuint index)
   {
-    glBindBufferBase(target, index, 0);
+    if (buffer_binding_changed(target, index, 0))
+      glBindBufferBase(target, index, 0);
   }
 
   // 6.2 Create / modify buffer object data (bindless).
@@ -294,6 +309,49 @@ protected:
   cudaGraphicsResource* resource_ = nullptr;
 #endif
 };
+
+// A range of a buffer for indexed binding. Default constructed ranges unbind.
+struct buffer_range
+{
+  buffer_range() = default;
+  buffer_range(const buffer& buffer, const GLintptr offset, const GLsizeiptr size) : id(buffer.id()), offset(offset), size(size)
+  {
+
+  }
+
+  GLuint     id     = 0;
+  GLintptr   offset = 0;
+  GLsizeiptr size   = 0;
+};
+
+// 6.1.1 Binding a buffer object to an indexed target - Multi-bind. Each batch of up to 32 binding points is bound by a single
+// call, skipping the binding points at either end which are already in place according to the state cache.
+inline void bind_buffers_range(const GLenum target, const GLuint first, const span<const buffer_range> ranges)
+{
+  std::array<GLuint    , 32> ids    ;
+  std::array<GLintptr  , 32> offsets;
+  std::array<GLsizeiptr, 32> sizes  ;
+  for (std::size_t offset = 0; offset < ranges.size(); offset += ids.size())
+  {
+    const auto  count = std::min(ids.size(), ranges.size() - offset);
+    const auto  index = first + static_cast<GLuint>(offset);
+    std::size_t begin = count, end = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      const auto& range = ranges[offset + i];
+      ids    [i] = range.id;
+      offsets[i] = range.offset;
+      sizes  [i] = range.size;
+      if (buffer_binding_changed(target, index + static_cast<GLuint>(i), range.id, range.offset, range.size))
+      {
+        begin = std::min(begin, i);
+        end   = i + 1;
+      }
+    }
+    if (begin < end)
+      glBindBuffersRange(target, index + static_cast<GLuint>(begin), static_cast<GLsizei>(end - begin), ids.data() + begin, offsets.data() + begin, sizes.data() + begin);
+  }
+}
 }
 
 #endif
\ No newline at end of file
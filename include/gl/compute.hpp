@@ -6,11 +6,26 @@
 #ifndef GL_COMPUTE_HPP
 #define GL_COMPUTE_HPP
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 #include <gl/opengl.hpp>
+#include <gl/buffer.hpp>
+#include <gl/program.hpp>
 
 namespace gl
 {
 // 19.0 Compute shaders.
+struct dispatch_indirect_command
+{
+  GLuint grid_x;
+  GLuint grid_y;
+  GLuint grid_z;
+};
+
 inline void dispatch_compute         (const GLuint grid_x, const GLuint grid_y, const GLuint grid_z)
 {
   glDispatchCompute(grid_x, grid_y, grid_z);
@@ -19,6 +34,115 @@ inline void dispatch_compute_indirect(const GLintptr offset)
 {
   glDispatchComputeIndirect(offset);
 }
+
+// 19.1 Compute shader variables.
+inline std::array<GLuint, 3> max_compute_work_group_count()
+{
+  std::array<GLint, 3> result {};
+  for (auto i = 0; i < 3; ++i)
+    glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, i, &result[i]);
+  return {static_cast<GLuint>(result[0]), static_cast<GLuint>(result[1]), static_cast<GLuint>(result[2])};
+}
+
+// X Extended Functionality - Buffer of dispatch_indirect_commands, which may be written by a previous dispatch
+// (bound as a shader storage buffer) and consumed by dispatch_compute_indirect without a round-trip to the CPU.
+// The commands are initialized to empty dispatches ({0, 1, 1}) along with the storage.
+class indirect_args : public buffer
+{
+public:
+  explicit indirect_args(const GLsizei count = 1, const GLbitfield storage_flags = GL_DYNAMIC_STORAGE_BIT) : count_(count)
+  {
+    const std::vector<dispatch_indirect_command> empty(static_cast<std::size_t>(std::max(count, 0)), dispatch_indirect_command {0, 1, 1});
+    set_data_immutable(static_cast<GLsizeiptr>(sizeof(dispatch_indirect_command) * empty.size()), empty.data(), storage_flags);
+  }
+
+  void set            (const GLsizei index, const dispatch_indirect_command& command) const
+  {
+    set_sub_data(offset(index), sizeof(dispatch_indirect_command), &command);
+  }
+  void bind_as_storage(const GLuint binding, const GLsizei index = 0, const GLsizei count = 1) const
+  {
+    bind_range(GL_SHADER_STORAGE_BUFFER, binding, offset(index), static_cast<GLsizeiptr>(sizeof(dispatch_indirect_command) * count));
+  }
+
+  [[nodiscard]]
+  GLsizei         count ()                    const
+  {
+    return count_;
+  }
+  [[nodiscard]]
+  static GLintptr offset(const GLsizei index)
+  {
+    return static_cast<GLintptr>(sizeof(dispatch_indirect_command) * index);
+  }
+
+protected:
+  GLsizei count_;
+};
+
+// X Extended Functionality - Dispatches enough work groups of the program to cover the given number of elements (invocations).
+// If the grid exceeds GL_MAX_COMPUTE_WORK_GROUP_COUNT, it is split into several dispatches and the offset of each (in invocations)
+// is written to the uvec3 uniform at offset_location, which the shader is expected to add to gl_GlobalInvocationID.
+// Since the grid is rounded up, the shader is also expected to discard invocations beyond the element count.
+// Returns false without dispatching if the program has no work group size (e.g. it is not a linked compute program), or if the
+// grid has to be split but no offset uniform is given.
+inline bool dispatch_3d(const program& program, const std::array<GLuint, 3>& elements, const GLint offset_location = -1)
+{
+  static const auto max_grid   = max_compute_work_group_count();
+  const auto        local_size = program.compute_work_group_size();
+  if (local_size[0] <= 0 || local_size[1] <= 0 || local_size[2] <= 0)
+    return false;
+
+  std::array<GLuint, 3> grid {};
+  for (auto i = 0; i < 3; ++i)
+    grid[i] = elements[i] / static_cast<GLuint>(local_size[i]) + (elements[i] % static_cast<GLuint>(local_size[i]) != 0);
+
+  program.use();
+  if (grid[0] <= max_grid[0] && grid[1] <= max_grid[1] && grid[2] <= max_grid[2])
+  {
+    if (offset_location != -1)
+      program.set_uniform_3ui(offset_location, std::array<GLuint, 3> {0, 0, 0});
+    dispatch_compute(grid[0], grid[1], grid[2]);
+    return true;
+  }
+
+  // The grid exceeds GL_MAX_COMPUTE_WORK_GROUP_COUNT and has to be split, which requires an offset uniform.
+  if (offset_location == -1)
+    return false;
+  // The offsets are counted in 64 bits, as stepping by the maximum count may pass 2^32 - 1.
+  for (std::uint64_t z = 0; z < grid[2]; z += max_grid[2])
+    for (std::uint64_t y = 0; y < grid[1]; y += max_grid[1])
+      for (std::uint64_t x = 0; x < grid[0]; x += max_grid[0])
+      {
+        program.set_uniform_3ui(offset_location, std::array<GLuint, 3> {
+          static_cast<GLuint>(x * local_size[0]),
+          static_cast<GLuint>(y * local_size[1]),
+          static_cast<GLuint>(z * local_size[2])});
+        dispatch_compute(
+          static_cast<GLuint>(std::min<std::uint64_t>(max_grid[0], grid[0] - x)),
+          static_cast<GLuint>(std::min<std::uint64_t>(max_grid[1], grid[1] - y)),
+          static_cast<GLuint>(std::min<std::uint64_t>(max_grid[2], grid[2] - z)));
+      }
+  return true;
+}
+inline bool dispatch_2d(const program& program, const std::array<GLuint, 2>& elements, const GLint offset_location = -1)
+{
+  return dispatch_3d(program, {elements[0], elements[1], 1}, offset_location);
+}
+inline bool dispatch_1d(const program& program, const GLuint                 elements, const GLint offset_location = -1)
+{
+  return dispatch_3d(program, {elements, 1, 1}, offset_location);
+}
+
+// Issues a command barrier first (by default), so that arguments written by a preceding dispatch are visible.
+inline void dispatch_compute_indirect(const program& program, const indirect_args& arguments, const GLsizei index = 0, const bool barrier = true)
+{
+  if (barrier)
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+  program  .use ();
+  arguments.bind(GL_DISPATCH_INDIRECT_BUFFER);
+  dispatch_compute_indirect(indirect_args::offset(index));
+}
 }
 
-#endif
\ No newline at end of file
+#endif
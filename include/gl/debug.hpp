@@ -9,10 +9,13 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include <gl/opengl.hpp>
+#include <gl/instrumentation.hpp>
 #include <gl/sync.hpp>
 
 namespace gl
@@ -37,15 +40,25 @@ inline bool debug_output_enabled    ()
 }
 
 // 20.2 Debug message callback.
+// Replaces the callback of any previous call. Each callback is copied to the heap and passed as the user data, hence a message
+// being handled concurrently (with GL_DEBUG_OUTPUT_SYNCHRONOUS disabled) keeps using the callback it started with. The callback
+// replaced is kept alive until the next replacement, which frees it. Allocates per message; see auxiliary/debug_message_ring.hpp
+// for an alternative.
 inline void set_debug_log_callback(const std::function<void(debug_log)>& callback)
 {
-  static auto function = callback;
+  static std::mutex                                            mutex   ;
+  static std::shared_ptr<const std::function<void(debug_log)>> current ;
+  static std::shared_ptr<const std::function<void(debug_log)>> previous;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  previous = std::move(current);
+  current  = std::make_shared<const std::function<void(debug_log)>>(callback);
   glDebugMessageCallback(static_cast<GLDEBUGPROC>([ ] (const GLenum source, const GLenum type, const GLuint id, const GLenum severity, GLsizei length, const GLchar* message, const void* data)
   {
     const auto* const function_ptr = static_cast<const std::function<void(debug_log)>*>(data);
     if (function_ptr != nullptr) 
       (*function_ptr)(debug_log({source, type, id, severity, std::string(message)}));
-  }), reinterpret_cast<const void*>(&function));
+  }), reinterpret_cast<const void*>(current.get()));
 }
 
 // 20.4 Controlling debug messages.
@@ -60,25 +73,29 @@ inline void insert_debug_log(const debug_log& log)
   glDebugMessageInsert(log.source, log.type, log.id, log.severity, static_cast<GLsizei>(log.message.size()), log.message.data());
 }
 
-// 20.6 Debug groups.
+// 20.6 Debug groups. Compile to nothing at instrumentation level 0.
 inline void push_debug_group(const GLenum source, const GLuint id, const std::string& message)
 {
-  glPushDebugGroup(source, id, static_cast<GLsizei>(message.size()), message.data());
+  if constexpr (debug_surface_enabled)
+    glPushDebugGroup(source, id, static_cast<GLsizei>(message.size()), message.data());
 }
 inline void pop_debug_group ()
 {
-  glPopDebugGroup();
+  if constexpr (debug_surface_enabled)
+    glPopDebugGroup();
 }
 
-// 20.7 Debug labels.
+// 20.7 Debug labels. Compile to nothing at instrumentation level 0.
 template<typename type>
 void        set_object_label     (const type& object     , const std::string& label)
 {
-  glObjectLabel(type::native_type, object.id(), static_cast<GLsizei>(label.size()), label.data());
+  if constexpr (debug_surface_enabled)
+    glObjectLabel(type::native_type, object.id(), static_cast<GLsizei>(label.size()), label.data());
 }
 inline void set_sync_object_label(const sync& sync_object, const std::string& label)
 {
-  glObjectPtrLabel(sync_object.id(), static_cast<GLsizei>(label.size()), label.data());
+  if constexpr (debug_surface_enabled)
+    glObjectPtrLabel(sync_object.id(), static_cast<GLsizei>(label.size()), label.data());
 }
 
 // 20.8 Synchronous Debug output.
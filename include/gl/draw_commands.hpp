@@ -6,12 +6,14 @@
 #ifndef GL_DRAW_COMMANDS_HPP
 #define GL_DRAW_COMMANDS_HPP
 
+#include <algorithm>
 #include <cstddef>
 #include <tuple>
 #include <utility>
-#include <vector>
 
 #include <gl/opengl.hpp>
+#include <gl/small_buffer.hpp>
+#include <gl/span.hpp>
 
 namespace gl
 {
@@ -76,17 +78,16 @@ inline void draw_arrays_indirect                             (const GLenum mode,
   glDrawArraysIndirect(mode, reinterpret_cast<const void*>(static_cast<std::size_t>(offset)));
 }
 
-inline void multi_draw_arrays                                (const GLenum mode, const std::vector<std::pair<GLint, GLsizei>>& offset_count_pairs)
+inline void multi_draw_arrays                                (const GLenum mode, const span<const GLint> offsets, const span<const GLsizei> counts)
 {
-  std::vector<GLint>   offsets;
-  std::vector<GLsizei> counts ;
-  offsets.reserve(offset_count_pairs.size());
-  counts .reserve(offset_count_pairs.size());
-  for (const auto& [offset, count] : offset_count_pairs)
-  {
-    offsets.push_back(offset);
-    counts .push_back(count );
-  }
+  glMultiDrawArrays(mode, offsets.data(), counts.data(), static_cast<GLsizei>(std::min(offsets.size(), counts.size())));
+}
+inline void multi_draw_arrays                                (const GLenum mode, const span<const std::pair<GLint, GLsizei>> offset_count_pairs)
+{
+  small_buffer<GLint>   offsets(offset_count_pairs.size());
+  small_buffer<GLsizei> counts (offset_count_pairs.size());
+  for (std::size_t i = 0; i < offset_count_pairs.size(); ++i)
+    std::tie(offsets[i], counts[i]) = offset_count_pairs[i];
   glMultiDrawArrays(mode, offsets.data(), counts.data(), static_cast<GLsizei>(offset_count_pairs.size()));
 }
 inline void multi_draw_arrays_indirect                       (const GLenum mode, const GLint offset, const GLsizei draw_count, const GLsizei stride = sizeof(draw_arrays_indirect_command))
@@ -119,16 +120,18 @@ inline void draw_elements_indirect                           (const GLenum mode,
   glDrawElementsIndirect(mode, type, reinterpret_cast<const void*>(static_cast<std::size_t>(offset)));
 }
 
-inline void multi_draw_elements                              (const GLenum mode, const GLenum type, const std::vector<std::pair<GLint, GLsizei>>& offset_count_pairs)
+inline void multi_draw_elements                              (const GLenum mode, const GLenum type, const span<const void* const> offsets, const span<const GLsizei> counts)
 {
-  std::vector<const void*> offsets;
-  std::vector<GLsizei>     counts ;
-  offsets.reserve(offset_count_pairs.size());
-  counts .reserve(offset_count_pairs.size());
-  for (const auto& [offset, count] : offset_count_pairs)
+  glMultiDrawElements(mode, counts.data(), type, offsets.data(), static_cast<GLsizei>(std::min(offsets.size(), counts.size())));
+}
+inline void multi_draw_elements                              (const GLenum mode, const GLenum type, const span<const std::pair<GLint, GLsizei>> offset_count_pairs)
+{
+  small_buffer<const void*> offsets(offset_count_pairs.size());
+  small_buffer<GLsizei>     counts (offset_count_pairs.size());
+  for (std::size_t i = 0; i < offset_count_pairs.size(); ++i)
   {
-    offsets.push_back(reinterpret_cast<const void*>(static_cast<std::size_t>(offset)));
-    counts .push_back(count);
+    offsets[i] = reinterpret_cast<const void*>(static_cast<std::size_t>(offset_count_pairs[i].first));
+    counts [i] = offset_count_pairs[i].second;
   }
   glMultiDrawElements(mode, counts.data(), type, offsets.data(), static_cast<GLsizei>(offset_count_pairs.size()));
 }
@@ -136,7 +139,7 @@ inline void multi_draw_elements_indirect                     (const GLenum mode,
 {
   glMultiDrawElementsIndirect(mode, type, reinterpret_cast<const void*>(static_cast<std::size_t>(offset)), draw_count, stride);
 }
-inline void multi_draw_elements_indirect_count               (const GLenum mode, const GLenum type, const GLint offset, const GLintptr draw_count, const GLsizei max_draw_count, const GLsizei stride = sizeof(draw_arrays_indirect_command))
+inline void multi_draw_elements_indirect_count               (const GLenum mode, const GLenum type, const GLint offset, const GLintptr draw_count, const GLsizei max_draw_count, const GLsizei stride = sizeof(draw_elements_indirect_command))
 {
   glMultiDrawElementsIndirectCount(mode, type, reinterpret_cast<const void*>(static_cast<std::size_t>(offset)), draw_count, max_draw_count, stride);
 }
@@ -158,19 +161,21 @@ inline void draw_range_elements_base_vertex                  (const GLenum mode,
   glDrawRangeElementsBaseVertex(mode, start, end, count, type, indices, base_vertex);
 }
 
-inline void multi_draw_elements_base_vertex                  (const GLenum mode, const GLenum type, const std::vector<std::tuple<GLint, GLsizei, GLint>>& offset_count_base_vertex_triplets)
-{
-  std::vector<void*>   offsets;
-  std::vector<GLsizei> counts;
-  std::vector<GLint>   base_vertices;
-  offsets      .reserve(offset_count_base_vertex_triplets.size());
-  counts       .reserve(offset_count_base_vertex_triplets.size());
-  base_vertices.reserve(offset_count_base_vertex_triplets.size());
-  for (const auto& [offset, count, base_vertex] : offset_count_base_vertex_triplets)
+inline void multi_draw_elements_base_vertex                  (const GLenum mode, const GLenum type, const span<const void* const> offsets, const span<const GLsizei> counts, const span<const GLint> base_vertices)
+{
+  glMultiDrawElementsBaseVertex(mode, counts.data(), type, offsets.data(), static_cast<GLsizei>(std::min({offsets.size(), counts.size(), base_vertices.size()})), base_vertices.data());
+}
+inline void multi_draw_elements_base_vertex                  (const GLenum mode, const GLenum type, const span<const std::tuple<GLint, GLsizei, GLint>> offset_count_base_vertex_triplets)
+{
+  small_buffer<const void*> offsets      (offset_count_base_vertex_triplets.size());
+  small_buffer<GLsizei>     counts       (offset_count_base_vertex_triplets.size());
+  small_buffer<GLint>       base_vertices(offset_count_base_vertex_triplets.size());
+  for (std::size_t i = 0; i < offset_count_base_vertex_triplets.size(); ++i)
   {
-    offsets      .push_back(reinterpret_cast<void*>(static_cast<std::size_t>(offset)));
-    counts       .push_back(count);
-    base_vertices.push_back(base_vertex);
+    const auto& [offset, count, base_vertex] = offset_count_base_vertex_triplets[i];
+    offsets      [i] = reinterpret_cast<const void*>(static_cast<std::size_t>(offset));
+    counts       [i] = count;
+    base_vertices[i] = base_vertex;
   }
   glMultiDrawElementsBaseVertex(mode, counts.data(), type, offsets.data(), static_cast<GLsizei>(offset_count_base_vertex_triplets.size()), base_vertices.data());
 }
@@ -11,6 +11,8 @@
 #include <vector>
 
 #include <gl/opengl.hpp>
+#include <gl/span.hpp>
+#include <gl/state_cache.hpp>
 #include <gl/texture.hpp>
 
 namespace gl
@@ -36,7 +38,10 @@ public:
   virtual ~framebuffer  ()
   {
     if (managed_ && id_ != invalid_id)
+    {
+      forget_object(GL_FRAMEBUFFER, id_);
       glDeleteFramebuffers(1, &id_);
+    }
   }
   framebuffer& operator=(const framebuffer&  that) = delete;
   framebuffer& operator=(      framebuffer&& temp) noexcept
@@ -44,7 +49,10 @@ public:
     if (this != &temp)
     {
       if (managed_ && id_ != invalid_id)
+      {
+        forget_object(GL_FRAMEBUFFER, id_);
         glDeleteFramebuffers(1, &id_);
+      }
   
       id_      = temp.id_;
       managed_ = temp.managed_;
@@ -58,11 +66,13 @@ public:
   // 9.2 Binding and managing.
   void        bind    (const GLenum target = GL_FRAMEBUFFER) const
   {
-    glBindFramebuffer(target, id_);
+    if (framebuffer_changed(target, id_))
+      glBindFramebuffer(target, id_);
   }
   static void unbind  (const GLenum target = GL_FRAMEBUFFER)
   {
-    glBindFramebuffer(target, 0);
+    if (framebuffer_changed(target, 0))
+      glBindFramebuffer(target, 0);
   }
   [[nodiscard]]
   bool        is_valid() const
@@ -255,7 +265,7 @@ public:
   {
     glNamedFramebufferDrawBuffer(id_, buffer);
   }
-  void set_draw_buffers(const std::vector<GLenum>& buffers) const
+  void set_draw_buffers(const span<const GLenum> buffers) const
   {
     glNamedFramebufferDrawBuffers(id_, static_cast<GLsizei>(buffers.size()), buffers.data());
   }
@@ -287,11 +297,11 @@ public:
   }
 
   // 17.4.4 Invalidate framebuffers (bindless).
-  void invalidate_sub_data(const std::vector<GLenum>& attachments, const GLint x, const GLint y, const GLsizei width, const GLsizei height) const
+  void invalidate_sub_data(const span<const GLenum> attachments, const GLint x, const GLint y, const GLsizei width, const GLsizei height) const
   {
     glInvalidateNamedFramebufferSubData(id_, static_cast<GLsizei>(attachments.size()), attachments.data(), x, y, width, height);
   }
-  void invalidate         (const std::vector<GLenum>& attachments) const
+  void invalidate         (const span<const GLenum> attachments) const
   {
     glInvalidateNamedFramebufferData(id_, static_cast<GLsizei>(attachments.size()), attachments.data());
   }
@@ -346,19 +356,23 @@ protected:
 // 17.4.2 Fine control of buffer updates.
 inline void set_color_mask  (const std::array<bool, 4>& mask)
 {
-  glColorMask(mask[0], mask[1], mask[2], mask[3]);
+  if (state_changed(state_cache::parameter::color_mask, mask))
+    glColorMask(mask[0], mask[1], mask[2], mask[3]);
 }
 inline void set_color_mask  (const GLuint index, const std::array<bool, 4>& mask)
 {
+  invalidate_state(state_cache::parameter::color_mask);
   glColorMaski(index, mask[0], mask[1], mask[2], mask[3]);
 }
 inline void set_depth_mask  (const bool   mask )
 {
-  glDepthMask(mask);
+  if (state_changed(state_cache::parameter::depth_mask, mask))
+    glDepthMask(mask);
 }
 inline void set_stencil_mask(const GLuint mask , const GLenum face = GL_FRONT_AND_BACK)
 {
-  glStencilMaskSeparate(face, mask);
+  if (state_changed(state_cache::parameter::stencil_mask_front, state_cache::parameter::stencil_mask_back, face, mask))
+    glStencilMaskSeparate(face, mask);
 }
 
 // 17.4.3 Clearing the buffers.
@@ -0,0 +1,102 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_INSTRUMENTATION_HPP
+#define GL_INSTRUMENTATION_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <gl/opengl.hpp>
+
+// The instrumentation level, usually set through the INSTRUMENTATION_LEVEL CMake option:
+// 0: Object labels and debug groups compile to nothing, and so does GL_CHECK beyond its expression.
+// 1: Object labels and debug groups are issued (default).
+// 2: Additionally, GL_CHECK(expression) reads every error raised by the expression into the error_log of the thread.
+#ifndef GL_INSTRUMENTATION_LEVEL
+#define GL_INSTRUMENTATION_LEVEL 1
+#endif
+
+namespace gl
+{
+constexpr bool debug_surface_enabled = GL_INSTRUMENTATION_LEVEL >= 1;
+constexpr bool error_checks_enabled  = GL_INSTRUMENTATION_LEVEL >= 2;
+
+struct error_record
+{
+  GLenum        error    = GL_NO_ERROR;
+  const char*   function = nullptr; // The checked expression.
+  const char*   file     = nullptr;
+  std::uint32_t line     = 0;
+};
+
+// A fixed ring of the last capacity errors caught by GL_CHECK on this thread, oldest first. Recording never allocates.
+class error_log
+{
+public:
+  static constexpr std::size_t capacity = 64;
+
+  static error_log& current()
+  {
+    static thread_local error_log instance;
+    return instance;
+  }
+
+  void        record  (const GLenum error, const char* function, const char* file, const std::uint32_t line)
+  {
+    records_[total_ % capacity] = error_record {error, function, file, line};
+    ++total_;
+  }
+  // Calls function(const error_record&) for each record held, oldest first.
+  template<typename function_type>
+  void        for_each(function_type&& function) const
+  {
+    for (auto i = total_ > capacity ? total_ - capacity : 0; i < total_; ++i)
+      function(records_[i % capacity]);
+  }
+  void        clear   ()
+  {
+    total_ = 0;
+  }
+
+  [[nodiscard]]
+  std::size_t size    () const
+  {
+    return total_ < capacity ? total_ : capacity;
+  }
+  // The number of errors recorded since the last clear(), including those overwritten.
+  [[nodiscard]]
+  std::size_t total   () const
+  {
+    return total_;
+  }
+
+protected:
+  std::array<error_record, capacity> records_ {};
+  std::size_t                        total_   = 0;
+};
+
+// Records every pending error against the function and call site. Returns the number of errors recorded.
+inline std::size_t check_errors(const char* function, const char* file, const std::uint32_t line)
+{
+  std::size_t result = 0;
+  if constexpr (error_checks_enabled)
+  {
+    for (auto error = glGetError(); error != GL_NO_ERROR; error = glGetError(), ++result)
+      error_log::current().record(error, function, file, line);
+  }
+  return result;
+}
+}
+
+// Evaluates the expression (usually a wrapper call) and, at instrumentation level 2, records the errors it raised with the call site.
+#if GL_INSTRUMENTATION_LEVEL >= 2
+#define GL_CHECK(expression) do { expression; ::gl::check_errors(#expression, __FILE__, static_cast<std::uint32_t>(__LINE__)); } while (false)
+#else
+#define GL_CHECK(expression) do { expression; } while (false)
+#endif
+
+#endif
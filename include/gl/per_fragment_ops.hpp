@@ -9,25 +9,28 @@
 #include <array>
 
 #include <gl/opengl.hpp>
+#include <gl/state_cache.hpp>
 
 namespace gl
 {
 // 17.3.2 Scissor test.
 inline void set_scissor_test_enabled(const bool enabled)
 {
-  enabled ? glEnable(GL_SCISSOR_TEST) : glDisable(GL_SCISSOR_TEST);
+  set_enabled(GL_SCISSOR_TEST, enabled);
 }
 inline bool scissor_test_enabled    ()
 {
-  return glIsEnabled(GL_SCISSOR_TEST) != 0;
+  return is_enabled(GL_SCISSOR_TEST);
 }
 inline void set_scissor             (const std::array<GLint, 2>& offset, const std::array<GLsizei, 2>& size)
 {
-  glScissor(offset[0], offset[1], size[0], size[1]);
+  if (state_changed(state_cache::parameter::scissor, offset, size))
+    glScissor(offset[0], offset[1], size[0], size[1]);
 }
 
 inline void set_indexed_scissor_test_enabled(const GLuint index, const bool enabled)
 {
+  invalidate_state(GL_SCISSOR_TEST);
   enabled ? glEnablei(GL_SCISSOR_TEST, index) : glDisablei(GL_SCISSOR_TEST, index);
 }
 inline bool indexed_scissor_test_enabled    (const GLuint index)
@@ -36,45 +39,47 @@ inline bool indexed_scissor_test_enabled    (const GLuint index)
 }
 inline void set_indexed_scissor             (const GLuint index, const std::array<GLint, 2>& offset, const std::array<GLsizei, 2>& size)
 {
+  invalidate_state(state_cache::parameter::scissor);
   glScissorIndexed(index, offset[0], offset[1], size[0], size[1]);
 }
 
 // 17.3.3 Multisample fragment operations.
 inline void set_sample_alpha_to_coverage_enabled(const bool enabled)
 {
-  enabled ? glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE) : glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+  set_enabled(GL_SAMPLE_ALPHA_TO_COVERAGE, enabled);
 }
 inline bool sample_alpha_to_coverage_enabled    ()
 {
-  return glIsEnabled(GL_SAMPLE_ALPHA_TO_COVERAGE) != 0;
+  return is_enabled(GL_SAMPLE_ALPHA_TO_COVERAGE);
 }
 inline void set_sample_alpha_to_one_enabled     (const bool enabled)
 {
-  enabled ? glEnable(GL_SAMPLE_ALPHA_TO_ONE) : glDisable(GL_SAMPLE_ALPHA_TO_ONE);
+  set_enabled(GL_SAMPLE_ALPHA_TO_ONE, enabled);
 }
 inline bool sample_alpha_to_one_enabled         ()
 {
-  return glIsEnabled(GL_SAMPLE_ALPHA_TO_ONE) != 0;
+  return is_enabled(GL_SAMPLE_ALPHA_TO_ONE);
 }
 inline void set_sample_coverage_enabled         (const bool enabled)
 {
-  enabled ? glEnable(GL_SAMPLE_COVERAGE) : glDisable(GL_SAMPLE_COVERAGE);
+  set_enabled(GL_SAMPLE_COVERAGE, enabled);
 }
 inline bool sample_coverage_enabled             ()
 {
-  return glIsEnabled(GL_SAMPLE_COVERAGE) != 0;
+  return is_enabled(GL_SAMPLE_COVERAGE);
 }
 inline void set_sample_mask_enabled             (const bool enabled)
 {
-  enabled ? glEnable(GL_SAMPLE_MASK) : glDisable(GL_SAMPLE_MASK);
+  set_enabled(GL_SAMPLE_MASK, enabled);
 }
 inline bool sample_mask_enabled                 ()
 {
-  return glIsEnabled(GL_SAMPLE_MASK) != 0;
+  return is_enabled(GL_SAMPLE_MASK);
 }
 inline void set_sample_coverage                 (const GLfloat value, const bool invert = false)
 {
-  glSampleCoverage(value, invert);
+  if (state_changed(state_cache::parameter::sample_coverage, value, invert))
+    glSampleCoverage(value, invert);
 }
 inline void set_sample_mask                     (const GLuint index, const GLbitfield mask)
 {
@@ -84,77 +89,86 @@ inline void set_sample_mask                     (const GLuint index, const GLbit
 // 17.3.5 Stencil test.
 inline void set_stencil_test_enabled(const bool enabled)
 {
-  enabled ? glEnable(GL_STENCIL_TEST) : glDisable(GL_STENCIL_TEST);
+  set_enabled(GL_STENCIL_TEST, enabled);
 }
 inline bool stencil_test_enabled    ()
 {
-  return glIsEnabled(GL_STENCIL_TEST) != 0;
+  return is_enabled(GL_STENCIL_TEST);
 }
 inline void set_stencil_function    (const GLenum function, const GLint reference_value, const GLuint mask         , const GLenum face = GL_FRONT_AND_BACK)
 {
-  glStencilFuncSeparate(face, function, reference_value, mask);
+  if (state_changed(state_cache::parameter::stencil_function_front, state_cache::parameter::stencil_function_back, face, function, reference_value, mask))
+    glStencilFuncSeparate(face, function, reference_value, mask);
 }
 inline void set_stencil_operation   (const GLenum stencil_fail, const GLenum depth_fail, const GLenum depth_success, const GLenum face = GL_FRONT_AND_BACK)
 {
-  glStencilOpSeparate(face, stencil_fail, depth_fail, depth_success);
+  if (state_changed(state_cache::parameter::stencil_operation_front, state_cache::parameter::stencil_operation_back, face, stencil_fail, depth_fail, depth_success))
+    glStencilOpSeparate(face, stencil_fail, depth_fail, depth_success);
 }
 
 // 17.3.6 Depth buffer test.
 inline void set_depth_test_enabled(const bool enabled)
 {
-  enabled ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+  set_enabled(GL_DEPTH_TEST, enabled);
 }
 inline bool depth_test_enabled    ()
 {
-  return glIsEnabled(GL_DEPTH_TEST) != 0;
+  return is_enabled(GL_DEPTH_TEST);
 }
 inline void set_depth_function    (const GLenum function = GL_LESS)
 {
-  glDepthFunc(function);
+  if (state_changed(state_cache::parameter::depth_function, function))
+    glDepthFunc(function);
 }
 
 // 17.3.7 SRGB conversion.
 inline void set_framebuffer_srgb_enabled(const bool enabled)
 {
-  enabled ? glEnable(GL_FRAMEBUFFER_SRGB) : glDisable(GL_FRAMEBUFFER_SRGB);
+  set_enabled(GL_FRAMEBUFFER_SRGB, enabled);
 }
 inline bool framebuffer_srgb_enabled    ()
 {
-  return glIsEnabled(GL_FRAMEBUFFER_SRGB) != 0;
+  return is_enabled(GL_FRAMEBUFFER_SRGB);
 }
 
 // 17.3.8 Blending.
 inline void set_blending_enabled(const bool enabled)
 {
-  enabled ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+  set_enabled(GL_BLEND, enabled);
 }
 inline bool blending_enabled    ()
 {
-  return glIsEnabled(GL_BLEND) != 0;
+  return is_enabled(GL_BLEND);
 }
 inline void set_blend_equation  (const GLenum mode       = GL_FUNC_ADD)
 {
-  glBlendEquation(mode);
+  if (state_changed(state_cache::parameter::blend_equation, mode, mode))
+    glBlendEquation(mode);
 }
 inline void set_blend_equation  (const GLenum rgb_mode   = GL_FUNC_ADD, const GLenum alpha_mode   = GL_FUNC_ADD)
 {
-  glBlendEquationSeparate(rgb_mode, alpha_mode);
+  if (state_changed(state_cache::parameter::blend_equation, rgb_mode, alpha_mode))
+    glBlendEquationSeparate(rgb_mode, alpha_mode);
 }
 inline void set_blend_function  (const GLenum source     = GL_ONE     , const GLenum destination  = GL_ZERO    )
 {
-  glBlendFunc(source, destination);
+  if (state_changed(state_cache::parameter::blend_function, source, source, destination, destination))
+    glBlendFunc(source, destination);
 }
 inline void set_blend_function  (const GLenum source_rgb = GL_ONE     , const GLenum source_alpha = GL_ONE     , const GLenum destination_rgb = GL_ZERO, const GLenum destination_alpha = GL_ZERO)
 {
-  glBlendFuncSeparate(source_rgb, destination_rgb, source_alpha, destination_alpha);
+  if (state_changed(state_cache::parameter::blend_function, source_rgb, source_alpha, destination_rgb, destination_alpha))
+    glBlendFuncSeparate(source_rgb, destination_rgb, source_alpha, destination_alpha);
 }
 inline void set_blend_color     (const std::array<GLfloat, 4>& color)
 {
-  glBlendColor(color[0], color[1], color[2], color[3]);
+  if (state_changed(state_cache::parameter::blend_color, color))
+    glBlendColor(color[0], color[1], color[2], color[3]);
 }
 
 inline void set_indexed_blending_enabled(const GLuint index, const bool enabled)
 {
+  invalidate_state(GL_BLEND);
   enabled ? glEnablei(GL_BLEND, index) : glDisablei(GL_BLEND, index);
 }
 inline bool indexed_blending_enabled    (const GLuint index)
@@ -163,43 +177,48 @@ inline bool indexed_blending_enabled    (const GLuint index)
 }
 inline void set_indexed_blend_equation  (const GLuint index, const GLenum mode       = GL_FUNC_ADD)
 {
+  invalidate_state(state_cache::parameter::blend_equation);
   glBlendEquationi(index, mode);
 }
 inline void set_indexed_blend_equation  (const GLuint index, const GLenum rgb_mode   = GL_FUNC_ADD, const GLenum alpha_mode   = GL_FUNC_ADD)
 {
+  invalidate_state(state_cache::parameter::blend_equation);
   glBlendEquationSeparatei(index, rgb_mode, alpha_mode);
 }
 inline void set_indexed_blend_function  (const GLuint index, const GLenum source     = GL_ONE     , const GLenum destination  = GL_ZERO)
 {
+  invalidate_state(state_cache::parameter::blend_function);
   glBlendFunci(index, source, destination);
 }
 inline void set_indexed_blend_function  (const GLuint index, const GLenum source_rgb = GL_ONE     , const GLenum source_alpha = GL_ONE, const GLenum destination_rgb = GL_ZERO, const GLenum destination_alpha = GL_ZERO)
 {
+  invalidate_state(state_cache::parameter::blend_function);
   glBlendFuncSeparatei(index, source_rgb, destination_rgb, source_alpha, destination_alpha);
 }
 
 // 17.3.10 Dithering.
 inline void set_dithering_enabled(const bool enabled)
 {
-  enabled ? glEnable(GL_DITHER) : glDisable(GL_DITHER);
+  set_enabled(GL_DITHER, enabled);
 }
 inline bool dithering_enabled    ()
 {
-  return glIsEnabled(GL_DITHER) != 0;
+  return is_enabled(GL_DITHER);
 }
 
 // 17.3.11 Logical operation.
 inline void set_logic_operation_enabled(const bool enabled)
 {
-  enabled ? glEnable(GL_COLOR_LOGIC_OP) : glDisable(GL_COLOR_LOGIC_OP);
+  set_enabled(GL_COLOR_LOGIC_OP, enabled);
 }
 inline bool logic_operation_enabled    ()
 {
-  return glIsEnabled(GL_COLOR_LOGIC_OP) != 0;
+  return is_enabled(GL_COLOR_LOGIC_OP);
 }
 inline void set_logic_operation        (const GLenum operation = GL_COPY)
 {
-  glLogicOp(operation);
+  if (state_changed(state_cache::parameter::logic_operation, operation))
+    glLogicOp(operation);
 }
 }
 
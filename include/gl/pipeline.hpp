@@ -137,7 +137,7 @@ public:
   [[nodiscard]]
   bool validate() const
   {
-    glValidateProgram(id_);
+    glValidateProgramPipeline(id_);
     return validation_status();
   }
 
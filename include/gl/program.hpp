@@ -8,11 +8,25 @@
 
 #include <algorithm>
 #include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GL_PROGRAM_SSE2
+#include <emmintrin.h>
+#endif
+
 #include <gl/opengl.hpp>
+#include <gl/small_buffer.hpp>
+#include <gl/span.hpp>
+#include <gl/state_cache.hpp>
 #include <gl/image_handle.hpp>
 #include <gl/shader.hpp>
 #include <gl/texture_handle.hpp>
@@ -23,6 +37,12 @@
 
 namespace gl
 {
+struct uniform_shadow_statistics
+{
+  std::size_t issued_calls  = 0;
+  std::size_t skipped_calls = 0;
+};
+
 // Next steps: Modularize uniform, uniform block, atomic counter, attribute accesses.
 class program
 {
@@ -37,15 +57,28 @@ public:
 
   }
   program(const program&  that) = delete;
-  program(      program&& temp) noexcept : id_(temp.id_), managed_(temp.managed_)
+  program(      program&& temp) noexcept
+  : id_                       (temp.id_)
+  , managed_                  (temp.managed_)
+  , uniform_shadowing_enabled_(temp.uniform_shadowing_enabled_)
+  , uniform_shadow_slots_     (std::move(temp.uniform_shadow_slots_))
+  , uniform_shadow_image_     (std::move(temp.uniform_shadow_image_))
+  , uniform_shadow_statistics_(temp.uniform_shadow_statistics_)
+  , compute_work_group_size_  (temp.compute_work_group_size_)
+  , subroutine_stages_        (std::move(temp.subroutine_stages_))
+  , subroutine_stages_built_  (temp.subroutine_stages_built_)
   {
     temp.id_ = invalid_id;
     temp.managed_ = false;
+    temp.uniform_shadowing_enabled_ = false;
   }
   virtual ~program()
   {
     if (managed_ && id_ != invalid_id)
+    {
+      forget_object(GL_PROGRAM, id_);
       glDeleteProgram(id_);
+    }
   }
   program& operator=(const program&  that) = delete;
   program& operator=(      program&& temp) noexcept
@@ -53,13 +86,24 @@ public:
     if (this != &temp)
     {
       if (managed_ && id_ != invalid_id)
+      {
+        forget_object(GL_PROGRAM, id_);
         glDeleteProgram(id_);
+      }
   
-      id_      = temp.id_;
-      managed_ = temp.managed_;
+      id_                        = temp.id_;
+      managed_                   = temp.managed_;
+      uniform_shadowing_enabled_ = temp.uniform_shadowing_enabled_;
+      uniform_shadow_slots_      = std::move(temp.uniform_shadow_slots_);
+      uniform_shadow_image_      = std::move(temp.uniform_shadow_image_);
+      uniform_shadow_statistics_ = temp.uniform_shadow_statistics_;
+      compute_work_group_size_   = temp.compute_work_group_size_;
+      subroutine_stages_         = std::move(temp.subroutine_stages_);
+      subroutine_stages_built_   = temp.subroutine_stages_built_;
   
-      temp.id_      = invalid_id;
-      temp.managed_ = false;    
+      temp.id_                        = invalid_id;
+      temp.managed_                   = false;    
+      temp.uniform_shadowing_enabled_ = false;
     }
     return *this;
   }
@@ -90,18 +134,46 @@ public:
   }
   [[nodiscard]]
   bool        link         () const
+  {
+    begin_link();
+    return end_link();
+  }
+  // Splits link() for parallel compilation (ARB_parallel_shader_compile): begin_link() returns without waiting for the linker;
+  // end_link(), which waits unless completion_status() is already true, must be called before the program is used.
+  void        begin_link   () const
   {
     glLinkProgram(id_);
-    return link_status();
+  }
+  [[nodiscard]]
+  bool        end_link     () const
+  {
+    compute_work_group_size_ = {};
+    clear_subroutine_stages();
+    const auto status = link_status();
+    if (status)
+      build_subroutine_stages();
+    if (status && uniform_shadowing_enabled_)
+      build_uniform_shadow();
+    return status;
   }
   void        use          () const
   {
+    if (!binding_changed(state_cache::binding::program, id_))
+      return;
     glUseProgram(id_);
+    current_id() = id_;
+    // Subroutine uniforms are reset by glUseProgram.
+    if (subroutine_stages_built_)
+      for (auto i = 0; i < 6; ++i)
+        apply_subroutines(i);
   }
 
   static void unuse        ()
   {
+    if (!binding_changed(state_cache::binding::program, 0))
+      return;
     glUseProgram(0);
+    current_id() = 0;
   }
   [[nodiscard]]
   bool        is_valid     () const
@@ -191,7 +263,18 @@ public:
   template<typename type = GLbyte>
   void              set_program_binary(const GLenum format, const std::vector<type>& binary)
   {
-    glProgramBinary(id_, format, static_cast<const void*>(binary.data()), static_cast<GLsizei>(binary.size()));
+    set_program_binary(format, static_cast<const void*>(binary.data()), static_cast<GLsizei>(binary.size() * sizeof(type)));
+  }
+  void              set_program_binary(const GLenum format, const void* binary, const GLsizei size)
+  {
+    glProgramBinary(id_, format, binary, size);
+    compute_work_group_size_ = {};
+    clear_subroutine_stages();
+    const auto status = link_status();
+    if (status)
+      build_subroutine_stages();
+    if (status && uniform_shadowing_enabled_)
+      build_uniform_shadow();
   }
 
   // 7.6 Uniform variables.
@@ -214,7 +297,7 @@ public:
   std::vector<GLuint> uniform_indices(const GLsizei count, const std::vector<std::string>& names) const
   {
     std::vector<GLuint> indices(names.size());
-    std::vector<const char*> names_c(names.size());
+    small_buffer<const char*> names_c(names.size());
     std::transform(names.begin(), names.end(), names_c.begin(), 
     [&](const std::string& varying)
     {
@@ -223,6 +306,11 @@ public:
     glGetUniformIndices(id_, count, names_c.data(), indices.data());
     return indices;
   }
+  // Writes the index of each name to the corresponding element of indices, which must be at least as large as names.
+  void                uniform_indices(const span<const char* const> names, const span<GLuint> indices) const
+  {
+    glGetUniformIndices(id_, static_cast<GLsizei>(names.size()), names.data(), indices.data());
+  }
 
   [[nodiscard]]
   std::tuple<std::string, GLenum, GLsizei> active_uniform(const GLuint index) const
@@ -458,236 +546,292 @@ public:
 
   void set_uniform_1i(const GLint location, const GLint value) const
   {
-    glProgramUniform1i(id_, location, value);
+    if (update_uniform_shadow(location, &value, sizeof value))
+      glProgramUniform1i(id_, location, value);
   }
-  void set_uniform_1i(const GLint location, const std::vector<GLint>&   value) const
+  void set_uniform_1i(const GLint location, const span<const GLint>     value) const
   {
-    glProgramUniform1iv(id_, location, static_cast<GLsizei>(value.size()), value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLint), static_cast<GLsizei>(value.size())))
+      glProgramUniform1iv(id_, location, static_cast<GLsizei>(value.size()), value.data());
   }
   void set_uniform_2i(const GLint location, const std::array<GLint, 2>& value) const
   {
-    glProgramUniform2i(id_, location, value[0], value[1]);
+    if (update_uniform_shadow(location, value.data(), sizeof value))
+      glProgramUniform2i(id_, location, value[0], value[1]);
   }
-  void set_uniform_2i(const GLint location, const std::vector<GLint>&   value) const
+  void set_uniform_2i(const GLint location, const span<const GLint>     value) const
   {
-    glProgramUniform2iv(id_, location, static_cast<GLsizei>(value.size()), value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLint) * 2, static_cast<GLsizei>(value.size() / 2)))
+      glProgramUniform2iv(id_, location, static_cast<GLsizei>(value.size() / 2), value.data());
   }
   void set_uniform_3i(const GLint location, const std::array<GLint, 3>& value) const
   {
-    glProgramUniform3i(id_, location, value[0], value[1], value[2]);
+    if (update_uniform_shadow(location, value.data(), sizeof value))
+      glProgramUniform3i(id_, location, value[0], value[1], value[2]);
   }
-  void set_uniform_3i(const GLint location, const std::vector<GLint>&   value) const
+  void set_uniform_3i(const GLint location, const span<const GLint>     value) const
   {
-    glProgramUniform3iv(id_, location, static_cast<GLsizei>(value.size()), value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLint) * 3, static_cast<GLsizei>(value.size() / 3)))
+      glProgramUniform3iv(id_, location, static_cast<GLsizei>(value.size() / 3), value.data());
   }
   void set_uniform_4i(const GLint location, const std::array<GLint, 4>& value) const
   {
-    glProgramUniform4i(id_, location, value[0], value[1], value[2], value[3]);
+    if (update_uniform_shadow(location, value.data(), sizeof value))
+      glProgramUniform4i(id_, location, value[0], value[1], value[2], value[3]);
   }
-  void set_uniform_4i(const GLint location, const std::vector<GLint>&   value) const
+  void set_uniform_4i(const GLint location, const span<const GLint>     value) const
   {
-    glProgramUniform4iv(id_, location, static_cast<GLsizei>(value.size()), value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLint) * 4, static_cast<GLsizei>(value.size() / 4)))
+      glProgramUniform4iv(id_, location, static_cast<GLsizei>(value.size() / 4), value.data());
   }
   
   void set_uniform_1ui(const GLint location, const GLuint value) const
   {
-    glProgramUniform1ui(id_, location, value);
+    if (update_uniform_shadow(location, &value, sizeof value))
+      glProgramUniform1ui(id_, location, value);
   }
-  void set_uniform_1ui(const GLint location, const std::vector<GLuint>&   value) const
+  void set_uniform_1ui(const GLint location, const span<const GLuint>     value) const
   {
-    glProgramUniform1uiv(id_, location, static_cast<GLsizei>(value.size()), value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLuint), static_cast<GLsizei>(value.size())))
+      glProgramUniform1uiv(id_, location, static_cast<GLsizei>(value.size()), value.data());
   }
   void set_uniform_2ui(const GLint location, const std::array<GLuint, 2>& value) const
   {
-    glProgramUniform2ui(id_, location, value[0], value[1]);
+    if (update_uniform_shadow(location, value.data(), sizeof value))
+      glProgramUniform2ui(id_, location, value[0], value[1]);
   }
-  void set_uniform_2ui(const GLint location, const std::vector<GLuint>&   value) const
+  void set_uniform_2ui(const GLint location, const span<const GLuint>     value) const
   {
-    glProgramUniform2uiv(id_, location, static_cast<GLsizei>(value.size()), value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLuint) * 2, static_cast<GLsizei>(value.size() / 2)))
+      glProgramUniform2uiv(id_, location, static_cast<GLsizei>(value.size() / 2), value.data());
   }
   void set_uniform_3ui(const GLint location, const std::array<GLuint, 3>& value) const
   {
-    glProgramUniform3ui(id_, location, value[0], value[1], value[2]);
+    if (update_uniform_shadow(location, value.data(), sizeof value))
+      glProgramUniform3ui(id_, location, value[0], value[1], value[2]);
   }
-  void set_uniform_3ui(const GLint location, const std::vector<GLuint>&   value) const
+  void set_uniform_3ui(const GLint location, const span<const GLuint>     value) const
   {
-    glProgramUniform3uiv(id_, location, static_cast<GLsizei>(value.size()), value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLuint) * 3, static_cast<GLsizei>(value.size() / 3)))
+      glProgramUniform3uiv(id_, location, static_cast<GLsizei>(value.size() / 3), value.data());
   }
   void set_uniform_4ui(const GLint location, const std::array<GLuint, 4>& value) const
   {
-    glProgramUniform4ui(id_, location, value[0], value[1], value[2], value[3]);
+    if (update_uniform_shadow(location, value.data(), sizeof value))
+      glProgramUniform4ui(id_, location, value[0], value[1], value[2], value[3]);
   }
-  void set_uniform_4ui(const GLint location, const std::vector<GLuint>&   value) const
+  void set_uniform_4ui(const GLint location, const span<const GLuint>     value) const
   {
-    glProgramUniform4uiv(id_, location, static_cast<GLsizei>(value.size()), value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLuint) * 4, static_cast<GLsizei>(value.size() / 4)))
+      glProgramUniform4uiv(id_, location, static_cast<GLsizei>(value.size() / 4), value.data());
   }
   
   void set_uniform_1f(const GLint location, const GLfloat value) const
   {
-    glProgramUniform1f(id_, location, value);
+    if (update_uniform_shadow(location, &value, sizeof value))
+      glProgramUniform1f(id_, location, value);
   }
-  void set_uniform_1f(const GLint location, const std::vector<GLfloat>&   value) const
+  void set_uniform_1f(const GLint location, const span<const GLfloat>     value) const
   {
-    glProgramUniform1fv(id_, location, static_cast<GLsizei>(value.size()), value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLfloat), static_cast<GLsizei>(value.size())))
+      glProgramUniform1fv(id_, location, static_cast<GLsizei>(value.size()), value.data());
   }
   void set_uniform_2f(const GLint location, const std::array<GLfloat, 2>& value) const
   {
-    glProgramUniform2f(id_, location, value[0], value[1]);
+    if (update_uniform_shadow(location, value.data(), sizeof value))
+      glProgramUniform2f(id_, location, value[0], value[1]);
   }
-  void set_uniform_2f(const GLint location, const std::vector<GLfloat>&   value) const
+  void set_uniform_2f(const GLint location, const span<const GLfloat>     value) const
   {
-    glProgramUniform2fv(id_, location, static_cast<GLsizei>(value.size()), value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLfloat) * 2, static_cast<GLsizei>(value.size() / 2)))
+      glProgramUniform2fv(id_, location, static_cast<GLsizei>(value.size() / 2), value.data());
   }
   void set_uniform_3f(const GLint location, const std::array<GLfloat, 3>& value) const
   {
-    glProgramUniform3f(id_, location, value[0], value[1], value[2]);
+    if (update_uniform_shadow(location, value.data(), sizeof value))
+      glProgramUniform3f(id_, location, value[0], value[1], value[2]);
   }
-  void set_uniform_3f(const GLint location, const std::vector<GLfloat>&   value) const
+  void set_uniform_3f(const GLint location, const span<const GLfloat>     value) const
   {
-    glProgramUniform3fv(id_, location, static_cast<GLsizei>(value.size()), value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLfloat) * 3, static_cast<GLsizei>(value.size() / 3)))
+      glProgramUniform3fv(id_, location, static_cast<GLsizei>(value.size() / 3), value.data());
   }
   void set_uniform_4f(const GLint location, const std::array<GLfloat, 4>& value) const
   {
-    glProgramUniform4f(id_, location, value[0], value[1], value[2], value[3]);
+    if (update_uniform_shadow(location, value.data(), sizeof value))
+      glProgramUniform4f(id_, location, value[0], value[1], value[2], value[3]);
   }
-  void set_uniform_4f(const GLint location, const std::vector<GLfloat>&   value) const
+  void set_uniform_4f(const GLint location, const span<const GLfloat>     value) const
   {
-    glProgramUniform4fv(id_, location, static_cast<GLsizei>(value.size()), value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLfloat) * 4, static_cast<GLsizei>(value.size() / 4)))
+      glProgramUniform4fv(id_, location, static_cast<GLsizei>(value.size() / 4), value.data());
   }
   
   void set_uniform_1d(const GLint location, const GLdouble value) const
   {
-    glProgramUniform1d(id_, location, value);
+    if (update_uniform_shadow(location, &value, sizeof value))
+      glProgramUniform1d(id_, location, value);
   }
-  void set_uniform_1d(const GLint location, const std::vector<GLdouble>&   value) const
+  void set_uniform_1d(const GLint location, const span<const GLdouble>     value) const
   {
-    glProgramUniform1dv(id_, location, static_cast<GLsizei>(value.size()), value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLdouble), static_cast<GLsizei>(value.size())))
+      glProgramUniform1dv(id_, location, static_cast<GLsizei>(value.size()), value.data());
   }
   void set_uniform_2d(const GLint location, const std::array<GLdouble, 2>& value) const
   {
-    glProgramUniform2d(id_, location, value[0], value[1]);
+    if (update_uniform_shadow(location, value.data(), sizeof value))
+      glProgramUniform2d(id_, location, value[0], value[1]);
   }
-  void set_uniform_2d(const GLint location, const std::vector<GLdouble>&   value) const
+  void set_uniform_2d(const GLint location, const span<const GLdouble>     value) const
   {
-    glProgramUniform2dv(id_, location, static_cast<GLsizei>(value.size()), value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLdouble) * 2, static_cast<GLsizei>(value.size() / 2)))
+      glProgramUniform2dv(id_, location, static_cast<GLsizei>(value.size() / 2), value.data());
   }
   void set_uniform_3d(const GLint location, const std::array<GLdouble, 3>& value) const
   {
-    glProgramUniform3d(id_, location, value[0], value[1], value[2]);
+    if (update_uniform_shadow(location, value.data(), sizeof value))
+      glProgramUniform3d(id_, location, value[0], value[1], value[2]);
   }
-  void set_uniform_3d(const GLint location, const std::vector<GLdouble>&   value) const
+  void set_uniform_3d(const GLint location, const span<const GLdouble>     value) const
   {
-    glProgramUniform3dv(id_, location, static_cast<GLsizei>(value.size()), value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLdouble) * 3, static_cast<GLsizei>(value.size() / 3)))
+      glProgramUniform3dv(id_, location, static_cast<GLsizei>(value.size() / 3), value.data());
   }
   void set_uniform_4d(const GLint location, const std::array<GLdouble, 4>& value) const
   {
-    glProgramUniform4d(id_, location, value[0], value[1], value[2], value[3]);
+    if (update_uniform_shadow(location, value.data(), sizeof value))
+      glProgramUniform4d(id_, location, value[0], value[1], value[2], value[3]);
   }
-  void set_uniform_4d(const GLint location, const std::vector<GLdouble>&   value) const
+  void set_uniform_4d(const GLint location, const span<const GLdouble>     value) const
   {
-    glProgramUniform4dv(id_, location, static_cast<GLsizei>(value.size()), value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLdouble) * 4, static_cast<GLsizei>(value.size() / 4)))
+      glProgramUniform4dv(id_, location, static_cast<GLsizei>(value.size() / 4), value.data());
   }
   
-  void set_uniform_matrix_22f(const GLint location, const std::vector<GLfloat>& value, const bool transpose) const
+  void set_uniform_matrix_22f(const GLint location, const span<const GLfloat>   value, const bool transpose) const
   {
-    glProgramUniformMatrix2fv(id_, location, static_cast<GLsizei>(value.size() / 4), transpose, value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLfloat) * 4, static_cast<GLsizei>(value.size() / 4), !transpose))
+      glProgramUniformMatrix2fv(id_, location, static_cast<GLsizei>(value.size() / 4), transpose, value.data());
   }
-  void set_uniform_matrix_33f(const GLint location, const std::vector<GLfloat>& value, const bool transpose) const
+  void set_uniform_matrix_33f(const GLint location, const span<const GLfloat>   value, const bool transpose) const
   {
-    glProgramUniformMatrix3fv(id_, location, static_cast<GLsizei>(value.size() / 9), transpose, value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLfloat) * 9, static_cast<GLsizei>(value.size() / 9), !transpose))
+      glProgramUniformMatrix3fv(id_, location, static_cast<GLsizei>(value.size() / 9), transpose, value.data());
   }
-  void set_uniform_matrix_44f(const GLint location, const std::vector<GLfloat>& value, const bool transpose) const
+  void set_uniform_matrix_44f(const GLint location, const span<const GLfloat>   value, const bool transpose) const
   {
-    glProgramUniformMatrix4fv(id_, location, static_cast<GLsizei>(value.size() / 16), transpose, value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLfloat) * 16, static_cast<GLsizei>(value.size() / 16), !transpose))
+      glProgramUniformMatrix4fv(id_, location, static_cast<GLsizei>(value.size() / 16), transpose, value.data());
   }
-  void set_uniform_matrix_23f(const GLint location, const std::vector<GLfloat>& value, const bool transpose) const
+  void set_uniform_matrix_23f(const GLint location, const span<const GLfloat>   value, const bool transpose) const
   {
-    glProgramUniformMatrix2x3fv(id_, location, static_cast<GLsizei>(value.size() / 6), transpose, value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLfloat) * 6, static_cast<GLsizei>(value.size() / 6), !transpose))
+      glProgramUniformMatrix2x3fv(id_, location, static_cast<GLsizei>(value.size() / 6), transpose, value.data());
   }
-  void set_uniform_matrix_32f(const GLint location, const std::vector<GLfloat>& value, const bool transpose) const
+  void set_uniform_matrix_32f(const GLint location, const span<const GLfloat>   value, const bool transpose) const
   {
-    glProgramUniformMatrix3x2fv(id_, location, static_cast<GLsizei>(value.size() / 6), transpose, value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLfloat) * 6, static_cast<GLsizei>(value.size() / 6), !transpose))
+      glProgramUniformMatrix3x2fv(id_, location, static_cast<GLsizei>(value.size() / 6), transpose, value.data());
   }
-  void set_uniform_matrix_24f(const GLint location, const std::vector<GLfloat>& value, const bool transpose) const
+  void set_uniform_matrix_24f(const GLint location, const span<const GLfloat>   value, const bool transpose) const
   {
-    glProgramUniformMatrix2x4fv(id_, location, static_cast<GLsizei>(value.size() / 8), transpose, value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLfloat) * 8, static_cast<GLsizei>(value.size() / 8), !transpose))
+      glProgramUniformMatrix2x4fv(id_, location, static_cast<GLsizei>(value.size() / 8), transpose, value.data());
   }
-  void set_uniform_matrix_42f(const GLint location, const std::vector<GLfloat>& value, const bool transpose) const
+  void set_uniform_matrix_42f(const GLint location, const span<const GLfloat>   value, const bool transpose) const
   {
-    glProgramUniformMatrix4x2fv(id_, location, static_cast<GLsizei>(value.size() / 8), transpose, value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLfloat) * 8, static_cast<GLsizei>(value.size() / 8), !transpose))
+      glProgramUniformMatrix4x2fv(id_, location, static_cast<GLsizei>(value.size() / 8), transpose, value.data());
   }
-  void set_uniform_matrix_34f(const GLint location, const std::vector<GLfloat>& value, const bool transpose) const
+  void set_uniform_matrix_34f(const GLint location, const span<const GLfloat>   value, const bool transpose) const
   {
-    glProgramUniformMatrix3x4fv(id_, location, static_cast<GLsizei>(value.size() / 12), transpose, value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLfloat) * 12, static_cast<GLsizei>(value.size() / 12), !transpose))
+      glProgramUniformMatrix3x4fv(id_, location, static_cast<GLsizei>(value.size() / 12), transpose, value.data());
   }
-  void set_uniform_matrix_43f(const GLint location, const std::vector<GLfloat>& value, const bool transpose) const
+  void set_uniform_matrix_43f(const GLint location, const span<const GLfloat>   value, const bool transpose) const
   {
-    glProgramUniformMatrix4x3fv(id_, location, static_cast<GLsizei>(value.size() / 12), transpose, value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLfloat) * 12, static_cast<GLsizei>(value.size() / 12), !transpose))
+      glProgramUniformMatrix4x3fv(id_, location, static_cast<GLsizei>(value.size() / 12), transpose, value.data());
   }
   
-  void set_uniform_matrix_22d(const GLint location, const std::vector<GLdouble>& value, const bool transpose) const
+  void set_uniform_matrix_22d(const GLint location, const span<const GLdouble>   value, const bool transpose) const
   {
-    glProgramUniformMatrix2dv(id_, location, static_cast<GLsizei>(value.size() / 4), transpose, value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLdouble) * 4, static_cast<GLsizei>(value.size() / 4), !transpose))
+      glProgramUniformMatrix2dv(id_, location, static_cast<GLsizei>(value.size() / 4), transpose, value.data());
   }
-  void set_uniform_matrix_33d(const GLint location, const std::vector<GLdouble>& value, const bool transpose) const
+  void set_uniform_matrix_33d(const GLint location, const span<const GLdouble>   value, const bool transpose) const
   {
-    glProgramUniformMatrix3dv(id_, location, static_cast<GLsizei>(value.size() / 9), transpose, value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLdouble) * 9, static_cast<GLsizei>(value.size() / 9), !transpose))
+      glProgramUniformMatrix3dv(id_, location, static_cast<GLsizei>(value.size() / 9), transpose, value.data());
   }
-  void set_uniform_matrix_44d(const GLint location, const std::vector<GLdouble>& value, const bool transpose) const
+  void set_uniform_matrix_44d(const GLint location, const span<const GLdouble>   value, const bool transpose) const
   {
-    glProgramUniformMatrix4dv(id_, location, static_cast<GLsizei>(value.size() / 16), transpose, value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLdouble) * 16, static_cast<GLsizei>(value.size() / 16), !transpose))
+      glProgramUniformMatrix4dv(id_, location, static_cast<GLsizei>(value.size() / 16), transpose, value.data());
   }
-  void set_uniform_matrix_23d(const GLint location, const std::vector<GLdouble>& value, const bool transpose) const
+  void set_uniform_matrix_23d(const GLint location, const span<const GLdouble>   value, const bool transpose) const
   {
-    glProgramUniformMatrix2x3dv(id_, location, static_cast<GLsizei>(value.size() / 6), transpose, value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLdouble) * 6, static_cast<GLsizei>(value.size() / 6), !transpose))
+      glProgramUniformMatrix2x3dv(id_, location, static_cast<GLsizei>(value.size() / 6), transpose, value.data());
   }
-  void set_uniform_matrix_32d(const GLint location, const std::vector<GLdouble>& value, const bool transpose) const
+  void set_uniform_matrix_32d(const GLint location, const span<const GLdouble>   value, const bool transpose) const
   {
-    glProgramUniformMatrix3x2dv(id_, location, static_cast<GLsizei>(value.size() / 6), transpose, value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLdouble) * 6, static_cast<GLsizei>(value.size() / 6), !transpose))
+      glProgramUniformMatrix3x2dv(id_, location, static_cast<GLsizei>(value.size() / 6), transpose, value.data());
   }
-  void set_uniform_matrix_24d(const GLint location, const std::vector<GLdouble>& value, const bool transpose) const
+  void set_uniform_matrix_24d(const GLint location, const span<const GLdouble>   value, const bool transpose) const
   {
-    glProgramUniformMatrix2x4dv(id_, location, static_cast<GLsizei>(value.size() / 8), transpose, value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLdouble) * 8, static_cast<GLsizei>(value.size() / 8), !transpose))
+      glProgramUniformMatrix2x4dv(id_, location, static_cast<GLsizei>(value.size() / 8), transpose, value.data());
   }
-  void set_uniform_matrix_42d(const GLint location, const std::vector<GLdouble>& value, const bool transpose) const
+  void set_uniform_matrix_42d(const GLint location, const span<const GLdouble>   value, const bool transpose) const
   {
-    glProgramUniformMatrix4x2dv(id_, location, static_cast<GLsizei>(value.size() / 8), transpose, value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLdouble) * 8, static_cast<GLsizei>(value.size() / 8), !transpose))
+      glProgramUniformMatrix4x2dv(id_, location, static_cast<GLsizei>(value.size() / 8), transpose, value.data());
   }
-  void set_uniform_matrix_34d(const GLint location, const std::vector<GLdouble>& value, const bool transpose) const
+  void set_uniform_matrix_34d(const GLint location, const span<const GLdouble>   value, const bool transpose) const
   {
-    glProgramUniformMatrix3x4dv(id_, location, static_cast<GLsizei>(value.size() / 12), transpose, value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLdouble) * 12, static_cast<GLsizei>(value.size() / 12), !transpose))
+      glProgramUniformMatrix3x4dv(id_, location, static_cast<GLsizei>(value.size() / 12), transpose, value.data());
   }
-  void set_uniform_matrix_43d(const GLint location, const std::vector<GLdouble>& value, const bool transpose) const
+  void set_uniform_matrix_43d(const GLint location, const span<const GLdouble>   value, const bool transpose) const
   {
-    glProgramUniformMatrix4x3dv(id_, location, static_cast<GLsizei>(value.size() / 12), transpose, value.data());
+    if (update_uniform_shadow(location, value.data(), sizeof(GLdouble) * 12, static_cast<GLsizei>(value.size() / 12), !transpose))
+      glProgramUniformMatrix4x3dv(id_, location, static_cast<GLsizei>(value.size() / 12), transpose, value.data());
   }
 
 #ifdef GL_ARB_bindless_texture
   void set_uniform_handle(const GLint location, const texture_handle&              value) const
   {
-    glProgramUniformHandleui64ARB(id_, location, value.id());
+    const auto id = value.id();
+    if (update_uniform_shadow(location, &id, sizeof id))
+      glProgramUniformHandleui64ARB(id_, location, id);
   }
-  void set_uniform_handle(const GLint location, const std::vector<texture_handle>& value) const
+  void set_uniform_handle(const GLint location, const span<const texture_handle>   value) const
   {
-    std::vector<GLuint64> ids(value.size());
+    small_buffer<GLuint64> ids(value.size());
     std::transform(value.begin(), value.end(), ids.begin(), [&](const texture_handle& iteratee)
     {
       return iteratee.id();
     });
-    glProgramUniformHandleui64vARB(id_, location, static_cast<GLsizei>(ids.size()), ids.data());
+    if (update_uniform_shadow(location, ids.data(), sizeof(GLuint64), static_cast<GLsizei>(ids.size())))
+      glProgramUniformHandleui64vARB(id_, location, static_cast<GLsizei>(ids.size()), ids.data());
   }
   void set_uniform_handle(const GLint location, const image_handle&                value) const
   {
-    glProgramUniformHandleui64ARB(id_, location, value.id());
+    const auto id = value.id();
+    if (update_uniform_shadow(location, &id, sizeof id))
+      glProgramUniformHandleui64ARB(id_, location, id);
   }
-  void set_uniform_handle(const GLint location, const std::vector<image_handle>&   value) const
+  void set_uniform_handle(const GLint location, const span<const image_handle>     value) const
   {
-    std::vector<GLuint64> ids(value.size());
+    small_buffer<GLuint64> ids(value.size());
     std::transform(value.begin(), value.end(), ids.begin(), [&](const image_handle& iteratee)
     {
       return iteratee.id();
     });
-    glProgramUniformHandleui64vARB(id_, location, static_cast<GLsizei>(ids.size()), ids.data());
+    if (update_uniform_shadow(location, ids.data(), sizeof(GLuint64), static_cast<GLsizei>(ids.size())))
+      glProgramUniformHandleui64vARB(id_, location, static_cast<GLsizei>(ids.size()), ids.data());
   }
 #endif
 
@@ -717,16 +861,20 @@ public:
   std::string         active_subroutine_name                               (const GLenum shader_type, const GLuint subroutine_index) const
   {
     std::string result;
+    GLsizei     length;
     result.resize(active_subroutine_max_length(shader_type));
-    glGetActiveSubroutineName(id_, shader_type, subroutine_index, static_cast<GLsizei>(result.size()), nullptr, &result[0]);
+    glGetActiveSubroutineName(id_, shader_type, subroutine_index, static_cast<GLsizei>(result.size()), &length, &result[0]);
+    result.resize(length);
     return result;
   }
   [[nodiscard]]
   std::string         active_subroutine_uniform_name                       (const GLenum shader_type, const GLuint subroutine_index) const
   {
     std::string result;
+    GLsizei     length;
     result.resize(active_subroutine_uniform_max_length(shader_type));
-    glGetActiveSubroutineUniformName(id_, shader_type, subroutine_index, static_cast<GLsizei>(result.size()), nullptr, &result[0]);
+    glGetActiveSubroutineUniformName(id_, shader_type, subroutine_index, static_cast<GLsizei>(result.size()), &length, &result[0]);
+    result.resize(length);
     return result;
   }
   [[nodiscard]]
@@ -748,6 +896,74 @@ public:
     glUniformSubroutinesuiv(shader_type, active_subroutine_uniform_location_count(shader_type), subroutine_indices.data());
   }
 
+  // X Extended Functionality - Cached subroutine selection.
+  // The selection of each stage is stored in a table (indexed by subroutine uniform location) built once after link, and 
+  // re-applied by use() since glUseProgram resets it. Changes to the selection of the current program are applied immediately,
+  // changes to any other program are applied when it is next used. The tables are built by a successful link() / end_link() /
+  // set_program_binary() (or on first access for programs linked elsewhere), initialized to the first compatible subroutine of
+  // each uniform, and applied right away if the program is current.
+  void   set_subroutine         (const GLenum shader_type, const GLint        uniform_location, const GLuint       subroutine_index) const
+  {
+    const auto stage = subroutine_stage_index(shader_type);
+    if (stage >= subroutine_shader_types.size())
+      return;
+    if (!subroutine_stages_built_)
+      build_subroutine_stages();
+
+    auto& selection = subroutine_stages_[stage].selection;
+    if (uniform_location < 0 || static_cast<std::size_t>(uniform_location) >= selection.size() || selection[uniform_location] == subroutine_index)
+      return;
+
+    selection[uniform_location] = subroutine_index;
+    if (current_id() == id_)
+      apply_subroutines(stage);
+  }
+  void   set_subroutine         (const GLenum shader_type, const std::string& uniform_name    , const std::string& subroutine_name ) const
+  {
+    const auto location = cached_subroutine_uniform_location(shader_type, uniform_name   );
+    const auto index    = cached_subroutine_index           (shader_type, subroutine_name);
+    if (location != -1 && index != GL_INVALID_INDEX)
+      set_subroutine(shader_type, location, index);
+  }
+  [[nodiscard]]
+  GLuint subroutine             (const GLenum shader_type, const GLint        uniform_location) const
+  {
+    const auto stage = subroutine_stage_index(shader_type);
+    if (stage >= subroutine_shader_types.size())
+      return GL_INVALID_INDEX;
+    if (!subroutine_stages_built_)
+      build_subroutine_stages();
+
+    const auto& selection = subroutine_stages_[stage].selection;
+    return uniform_location >= 0 && static_cast<std::size_t>(uniform_location) < selection.size() ? selection[uniform_location] : GL_INVALID_INDEX;
+  }
+  [[nodiscard]]
+  GLint  cached_subroutine_uniform_location(const GLenum shader_type, const std::string& name) const
+  {
+    const auto stage = subroutine_stage_index(shader_type);
+    if (stage >= subroutine_shader_types.size())
+      return -1;
+    if (!subroutine_stages_built_)
+      build_subroutine_stages();
+
+    const auto& locations = subroutine_stages_[stage].uniform_locations;
+    const auto  iterator  = locations.find(name);
+    return iterator != locations.end() ? iterator->second : -1;
+  }
+  [[nodiscard]]
+  GLuint cached_subroutine_index            (const GLenum shader_type, const std::string& name) const
+  {
+    const auto stage = subroutine_stage_index(shader_type);
+    if (stage >= subroutine_shader_types.size())
+      return GL_INVALID_INDEX;
+    if (!subroutine_stages_built_)
+      build_subroutine_stages();
+
+    const auto& indices  = subroutine_stages_[stage].indices;
+    const auto  iterator = indices.find(name);
+    return iterator != indices.end() ? iterator->second : GL_INVALID_INDEX;
+  }
+
   // 7.13 Program queries.
   [[nodiscard]]
   bool    delete_status                           () const
@@ -759,6 +975,17 @@ public:
   {
     return get_parameter(GL_LINK_STATUS) != 0;
   }
+  // Whether linking has finished, hence link_status() would not block. Always true without ARB_parallel_shader_compile.
+  [[nodiscard]]
+  bool    completion_status                       () const
+  {
+    GLint result = GL_TRUE;
+#ifdef GL_ARB_parallel_shader_compile
+    if (parallel_shader_compile_supported())
+      glGetProgramiv(id_, GL_COMPLETION_STATUS_ARB, &result);
+#endif
+    return result != 0;
+  }
   [[nodiscard]]
   bool    validation_status                       () const
   {
@@ -888,9 +1115,10 @@ public:
   [[nodiscard]]
   std::array<GLint, 3> compute_work_group_size() const
   {
-    std::array<GLint, 3> result {};
-    glGetProgramiv(id_, GL_COMPUTE_WORK_GROUP_SIZE, result.data());
-    return result;
+    // Fixed at link time, hence queried once per link.
+    if (compute_work_group_size_[0] == 0)
+      glGetProgramiv(id_, GL_COMPUTE_WORK_GROUP_SIZE, compute_work_group_size_.data());
+    return compute_work_group_size_;
   }
 
   [[nodiscard]]
@@ -1215,9 +1443,9 @@ public:
   }
   
   // 11.1.2 Transform feedback variables.
-  void set_transform_feedback_varyings(const std::vector<std::string>& varyings, const GLenum buffer_mode)
+  void set_transform_feedback_varyings(const std::vector<std::string>&  varyings, const GLenum buffer_mode)
   {
-    std::vector<const char*> varyings_c(varyings.size());
+    small_buffer<const char*> varyings_c(varyings.size());
     std::transform(varyings.begin(), varyings.end(), varyings_c.begin(), [&](const std::string& varying)
     {
       return varying.c_str();
@@ -1277,6 +1505,39 @@ public:
     static_assert(sizeof(type) == 0, "Type not allowed.");
   }
 
+  // X Extended Functionality - Uniform shadowing.
+  // When enabled, the uniform setters keep a byte image of the default block uniforms (indexed by location) 
+  // and only issue the GL call when the value differs from the last one set through this object.
+  // Uniforms modified without going through this object (e.g. glUniform* on the current program) require invalidate_uniform_shadow().
+  void set_uniform_shadowing_enabled(const bool enabled)
+  {
+    uniform_shadowing_enabled_ = enabled;
+    uniform_shadow_slots_.clear();
+    uniform_shadow_image_.clear();
+    if (enabled && link_status())
+      build_uniform_shadow();
+  }
+  [[nodiscard]]
+  bool uniform_shadowing_enabled() const
+  {
+    return uniform_shadowing_enabled_;
+  }
+  void invalidate_uniform_shadow() const
+  {
+    for (auto& slot : uniform_shadow_slots_)
+      slot.valid = false;
+  }
+
+  [[nodiscard]]
+  const gl::uniform_shadow_statistics& uniform_shadow_statistics      () const
+  {
+    return uniform_shadow_statistics_;
+  }
+  void                                 reset_uniform_shadow_statistics() const
+  {
+    uniform_shadow_statistics_ = gl::uniform_shadow_statistics();
+  }
+
   static const GLenum native_type = GL_PROGRAM;
 
   [[nodiscard]]
@@ -1336,8 +1597,217 @@ protected:
     return result;
   }
 
+  struct uniform_shadow_slot
+  {
+    std::size_t offset       = 0;
+    std::size_t element_size = 0; // Zero for locations which are not part of the default block.
+    std::size_t extent       = 0; // Bytes from offset until the end of the uniform (array).
+    bool        valid        = false;
+  };
+
+  // Returns whether the GL call should be issued.
+  bool update_uniform_shadow(const GLint location, const void* data, const std::size_t element_size, const GLsizei count = 1, const bool shadowable = true) const
+  {
+    if (!uniform_shadowing_enabled_)
+      return true;
+
+    ++uniform_shadow_statistics_.issued_calls;
+    if (location < 0 || static_cast<std::size_t>(location) >= uniform_shadow_slots_.size() || count <= 0)
+      return true;
+
+    const auto size = element_size * static_cast<std::size_t>(count);
+    auto&      slot = uniform_shadow_slots_[location];
+    if (!shadowable || slot.element_size != element_size || size > slot.extent)
+    {
+      // The value is changed in a way the shadow cannot represent (transposed, differently typed, out of range).
+      const auto last = std::min(uniform_shadow_slots_.size(), static_cast<std::size_t>(location) + static_cast<std::size_t>(count));
+      for (auto i = static_cast<std::size_t>(location); i < last; ++i)
+        uniform_shadow_slots_[i].valid = false;
+      return true;
+    }
+
+    auto* shadow = uniform_shadow_image_.data() + slot.offset;
+    auto  valid  = true;
+    for (auto i = 0; i < count && valid; ++i)
+      valid = uniform_shadow_slots_[location + i].valid;
+    if (valid && uniform_shadow_equal(shadow, data, size))
+    {
+      --uniform_shadow_statistics_.issued_calls;
+      ++uniform_shadow_statistics_.skipped_calls;
+      return false;
+    }
+
+    std::memcpy(shadow, data, size);
+    for (auto i = 0; i < count; ++i)
+      uniform_shadow_slots_[location + i].valid = true;
+    return true;
+  }
+  void build_uniform_shadow () const
+  {
+    uniform_shadow_slots_.clear();
+    uniform_shadow_image_.clear();
+
+    const std::array<GLenum, 4> properties {GL_BLOCK_INDEX, GL_LOCATION, GL_TYPE, GL_ARRAY_SIZE};
+    const auto count = interface_active_resources(GL_UNIFORM);
+    for (auto i = 0; i < count; ++i)
+    {
+      std::array<GLint, 4> values {};
+      glGetProgramResourceiv(id_, GL_UNIFORM, static_cast<GLuint>(i), static_cast<GLsizei>(properties.size()), properties.data(), static_cast<GLsizei>(values.size()), nullptr, values.data());
+      const auto [block_index, location, type, array_size] = values;
+      if (block_index != -1 || location < 0 || array_size <= 0)
+        continue;
+
+      const auto element_size = uniform_type_size(static_cast<GLenum>(type));
+      const auto offset       = uniform_shadow_image_.size();
+      uniform_shadow_image_.resize(offset + element_size * array_size);
+      if (uniform_shadow_slots_.size() < static_cast<std::size_t>(location + array_size))
+        uniform_shadow_slots_.resize(location + array_size);
+      for (auto j = 0; j < array_size; ++j)
+        uniform_shadow_slots_[location + j] = uniform_shadow_slot {offset + element_size * j, element_size, element_size * (array_size - j), false};
+    }
+  }
+
+  struct subroutine_stage
+  {
+    std::vector<GLuint>                     selection        ;
+    std::unordered_map<std::string, GLint>  uniform_locations;
+    std::unordered_map<std::string, GLuint> indices          ;
+  };
+
+  static constexpr std::array<GLenum, 6> subroutine_shader_types {GL_VERTEX_SHADER, GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER, GL_GEOMETRY_SHADER, GL_FRAGMENT_SHADER, GL_COMPUTE_SHADER};
+
+  // Returns subroutine_shader_types.size() for types which are not shader stages.
+  static std::size_t subroutine_stage_index(const GLenum shader_type)
+  {
+    const auto result = static_cast<std::size_t>(std::find(subroutine_shader_types.begin(), subroutine_shader_types.end(), shader_type) - subroutine_shader_types.begin());
+    assert(result < subroutine_shader_types.size() && "Unsupported shader type!");
+    return result;
+  }
+  void build_subroutine_stages() const
+  {
+    for (std::size_t i = 0; i < subroutine_shader_types.size(); ++i)
+    {
+      const auto shader_type = subroutine_shader_types[i];
+      auto&      stage       = subroutine_stages_[i];
+      stage.selection.assign(active_subroutine_uniform_location_count(shader_type), 0);
+      if (stage.selection.empty())
+        continue;
+
+      for (auto j = 0; j < active_subroutine_uniform_count(shader_type); ++j)
+      {
+        const auto uniform    = static_cast<GLuint>(j);
+        auto       name       = active_subroutine_uniform_name(shader_type, uniform);
+        const auto location   = subroutine_uniform_location(shader_type, name);
+        const auto compatible = active_subroutine_uniform_compatible_subroutines(shader_type, uniform);
+        GLint      array_size = 1;
+        glGetActiveSubroutineUniformiv(id_, shader_type, uniform, GL_UNIFORM_SIZE, &array_size);
+        for (auto k = 0; k < array_size && !compatible.empty(); ++k)
+          if (static_cast<std::size_t>(location + k) < stage.selection.size())
+            stage.selection[location + k] = compatible[0];
+        stage.uniform_locations.emplace(std::move(name), location);
+      }
+      for (auto j = 0; j < active_subroutine_count(shader_type); ++j)
+        stage.indices.emplace(active_subroutine_name(shader_type, static_cast<GLuint>(j)), static_cast<GLuint>(j));
+    }
+    subroutine_stages_built_ = true;
+
+    if (current_id() == id_)
+      for (std::size_t i = 0; i < subroutine_shader_types.size(); ++i)
+        apply_subroutines(i);
+  }
+  void clear_subroutine_stages() const
+  {
+    for (auto& stage : subroutine_stages_)
+      stage = subroutine_stage();
+    subroutine_stages_built_ = false;
+  }
+  void apply_subroutines      (const std::size_t stage) const
+  {
+    const auto& selection = subroutine_stages_[stage].selection;
+    if (!selection.empty())
+      glUniformSubroutinesuiv(subroutine_shader_types[stage], static_cast<GLsizei>(selection.size()), selection.data());
+  }
+
+  // The program last made current through use() / unuse() on this thread.
+  static GLuint&     current_id          ()
+  {
+    static thread_local GLuint id = 0;
+    return id;
+  }
+
+  static bool        uniform_shadow_equal(const void* lhs, const void* rhs, std::size_t size)
+  {
+#ifdef GL_PROGRAM_SSE2
+    const auto* lhs_bytes = static_cast<const std::uint8_t*>(lhs);
+    const auto* rhs_bytes = static_cast<const std::uint8_t*>(rhs);
+    for (; size >= 16; size -= 16, lhs_bytes += 16, rhs_bytes += 16)
+    {
+      const auto equal = _mm_cmpeq_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs_bytes)), 
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs_bytes)));
+      if (_mm_movemask_epi8(equal) != 0xFFFF)
+        return false;
+    }
+    return std::memcmp(lhs_bytes, rhs_bytes, size) == 0;
+#else
+    return std::memcmp(lhs, rhs, size) == 0;
+#endif
+  }
+  static std::size_t uniform_type_size   (const GLenum type)
+  {
+    switch (type)
+    {
+    case GL_FLOAT:             return sizeof(GLfloat);
+    case GL_FLOAT_VEC2:        return sizeof(GLfloat)  * 2;
+    case GL_FLOAT_VEC3:        return sizeof(GLfloat)  * 3;
+    case GL_FLOAT_VEC4:        return sizeof(GLfloat)  * 4;
+    case GL_DOUBLE:            return sizeof(GLdouble);
+    case GL_DOUBLE_VEC2:       return sizeof(GLdouble) * 2;
+    case GL_DOUBLE_VEC3:       return sizeof(GLdouble) * 3;
+    case GL_DOUBLE_VEC4:       return sizeof(GLdouble) * 4;
+    case GL_INT_VEC2:          
+    case GL_BOOL_VEC2:         return sizeof(GLint)    * 2;
+    case GL_INT_VEC3:          
+    case GL_BOOL_VEC3:         return sizeof(GLint)    * 3;
+    case GL_INT_VEC4:          
+    case GL_BOOL_VEC4:         return sizeof(GLint)    * 4;
+    case GL_UNSIGNED_INT_VEC2: return sizeof(GLuint)   * 2;
+    case GL_UNSIGNED_INT_VEC3: return sizeof(GLuint)   * 3;
+    case GL_UNSIGNED_INT_VEC4: return sizeof(GLuint)   * 4;
+    case GL_FLOAT_MAT2:        return sizeof(GLfloat)  * 4;
+    case GL_FLOAT_MAT3:        return sizeof(GLfloat)  * 9;
+    case GL_FLOAT_MAT4:        return sizeof(GLfloat)  * 16;
+    case GL_FLOAT_MAT2x3:      
+    case GL_FLOAT_MAT3x2:      return sizeof(GLfloat)  * 6;
+    case GL_FLOAT_MAT2x4:      
+    case GL_FLOAT_MAT4x2:      return sizeof(GLfloat)  * 8;
+    case GL_FLOAT_MAT3x4:      
+    case GL_FLOAT_MAT4x3:      return sizeof(GLfloat)  * 12;
+    case GL_DOUBLE_MAT2:       return sizeof(GLdouble) * 4;
+    case GL_DOUBLE_MAT3:       return sizeof(GLdouble) * 9;
+    case GL_DOUBLE_MAT4:       return sizeof(GLdouble) * 16;
+    case GL_DOUBLE_MAT2x3:     
+    case GL_DOUBLE_MAT3x2:     return sizeof(GLdouble) * 6;
+    case GL_DOUBLE_MAT2x4:     
+    case GL_DOUBLE_MAT4x2:     return sizeof(GLdouble) * 8;
+    case GL_DOUBLE_MAT3x4:     
+    case GL_DOUBLE_MAT4x3:     return sizeof(GLdouble) * 12;
+    default:                   return sizeof(GLint); // Scalars, samplers and images are set as a single 32-bit value.
+    }
+  }
+
   GLuint id_      = invalid_id;
   bool   managed_ = true;
+
+  bool                                     uniform_shadowing_enabled_ = false;
+  mutable std::vector<uniform_shadow_slot> uniform_shadow_slots_      ;
+  mutable std::vector<std::uint8_t>        uniform_shadow_image_      ;
+  mutable gl::uniform_shadow_statistics    uniform_shadow_statistics_ ;
+
+  mutable std::array<GLint, 3>             compute_work_group_size_   {};
+
+  mutable std::array<subroutine_stage, 6>  subroutine_stages_         ;
+  mutable bool                             subroutine_stages_built_   = false;
 };
 
 // X Extended Functionality - Type-inferring uniform setters.
@@ -6,9 +6,15 @@
 #ifndef GL_QUERY_HPP
 #define GL_QUERY_HPP
 
+#include <algorithm>
+#include <cstddef>
+#include <deque>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <gl/opengl.hpp>
+#include <gl/buffer.hpp>
 
 namespace gl
 {    
@@ -102,28 +108,40 @@ public:
   }
 
   [[nodiscard]]
-  bool   available     () const
+  bool     available     () const
   {
     return get_parameter_64(GL_QUERY_RESULT_AVAILABLE) != 0;
   }
   [[nodiscard]]
-  GLuint result_no_wait() const
+  GLuint64 result_no_wait() const
   {
     return get_parameter_64(GL_QUERY_RESULT_NO_WAIT);
   }
   [[nodiscard]]
-  GLuint result        () const
+  GLuint64 result        () const
   {
     return get_parameter_64(GL_QUERY_RESULT);
   }
 
+  // 4.2.1 Query object results in buffer objects (bindless). The result is written by the GPU, without a round trip through the
+  // client: GL_QUERY_RESULT waits for it on the GPU, GL_QUERY_RESULT_NO_WAIT writes it only if available and GL_QUERY_RESULT_AVAILABLE
+  // writes the availability instead. Offsets must be aligned to the size of the result (8 bytes, or 4 for the 32-bit variant).
+  void result_to_buffer   (const buffer& buffer, const GLintptr offset, const GLenum wait_mode = GL_QUERY_RESULT) const
+  {
+    glGetQueryBufferObjectui64v(id_, buffer.id(), wait_mode, offset);
+  }
+  void result_to_buffer_32(const buffer& buffer, const GLintptr offset, const GLenum wait_mode = GL_QUERY_RESULT) const
+  {
+    glGetQueryBufferObjectuiv  (id_, buffer.id(), wait_mode, offset);
+  }
+
   // 4.3 Timer queries.
-  template<typename = typename std::enable_if<target == GL_TIME_ELAPSED || target == GL_TIMESTAMP>::type>
+  template<GLenum type = target, typename = std::enable_if_t<type == GL_TIME_ELAPSED || type == GL_TIMESTAMP>>
   void           counter  () const
   {
     glQueryCounter(id_, GL_TIMESTAMP);
   }
-  template<typename = typename std::enable_if<target == GL_TIME_ELAPSED || target == GL_TIMESTAMP>::type>
+  template<GLenum type = target, typename = std::enable_if_t<type == GL_TIME_ELAPSED || type == GL_TIMESTAMP>>
   static GLint64 timestamp()
   {
     GLint64 result;
@@ -132,12 +150,12 @@ public:
   }
 
   // 10.9 Conditional rendering.
-  template<typename = typename std::enable_if<target == GL_SAMPLES_PASSED || target == GL_ANY_SAMPLES_PASSED>::type>
+  template<GLenum type = target, typename = std::enable_if_t<type == GL_SAMPLES_PASSED || type == GL_ANY_SAMPLES_PASSED>>
   void        begin_conditional_render(const GLenum mode = GL_QUERY_BY_REGION_NO_WAIT) const
   {
     glBeginConditionalRender(id_, mode);
   }
-  template<typename = typename std::enable_if<target == GL_SAMPLES_PASSED || target == GL_ANY_SAMPLES_PASSED>::type>
+  template<GLenum type = target, typename = std::enable_if_t<type == GL_SAMPLES_PASSED || type == GL_ANY_SAMPLES_PASSED>>
   static void end_conditional_render  ()
   {
     glEndConditionalRender();
@@ -164,6 +182,98 @@ protected:
   bool   managed_ = true;
 };
 
+// X Extended Functionality - Query pools.
+// Creates queries in bulk and recycles them, so that per-frame queries need not create and delete GL objects. The references
+// returned by acquire() stay valid until the pool is destroyed; release them once their results have been read.
+template<GLenum target>
+class query_pool
+{
+public:
+  explicit query_pool  (const std::size_t size = 0, const std::size_t growth = 32) : growth_(std::max<std::size_t>(growth, 1))
+  {
+    grow(size);
+  }
+  query_pool           (const query_pool&  that) = delete;
+  query_pool           (      query_pool&& temp) noexcept : queries_(std::move(temp.queries_)), free_(std::move(temp.free_)), growth_(temp.growth_)
+  {
+    temp.queries_.clear();
+    temp.free_   .clear();
+  }
+  virtual ~query_pool  ()
+  {
+    destroy();
+  }
+  query_pool& operator=(const query_pool&  that) = delete;
+  query_pool& operator=(      query_pool&& temp) noexcept
+  {
+    if (this != &temp)
+    {
+      destroy();
+
+      queries_ = std::move(temp.queries_);
+      free_    = std::move(temp.free_   );
+      growth_  = temp.growth_;
+
+      temp.queries_.clear();
+      temp.free_   .clear();
+    }
+    return *this;
+  }
+
+  [[nodiscard]]
+  const query<target>& acquire()
+  {
+    if (free_.empty())
+      grow(growth_);
+    const auto* result = free_.back();
+    free_.pop_back();
+    return *result;
+  }
+  void                 release(const query<target>& value)
+  {
+    free_.push_back(&value);
+  }
+
+  [[nodiscard]]
+  std::size_t          size     () const
+  {
+    return queries_.size();
+  }
+  [[nodiscard]]
+  std::size_t          available() const
+  {
+    return free_.size();
+  }
+
+protected:
+  void grow   (const std::size_t count)
+  {
+    if (count == 0)
+      return;
+    std::vector<GLuint> ids(count);
+    glCreateQueries(target, static_cast<GLsizei>(count), ids.data());
+    for (const auto id : ids)
+    {
+      queries_.emplace_back(id);
+      free_   .push_back   (&queries_.back());
+    }
+  }
+  void destroy()
+  {
+    std::vector<GLuint> ids;
+    ids.reserve(queries_.size());
+    for (const auto& iteratee : queries_)
+      ids.push_back(iteratee.id());
+    glDeleteQueries(static_cast<GLsizei>(ids.size()), ids.data());
+    queries_.clear();
+    free_   .clear();
+  }
+
+  std::deque<query<target>>         queries_; // Unmanaged, deleted by the pool.
+  std::vector<const query<target>*> free_   ;
+  std::size_t                       growth_ ;
+};
+
 using any_samples_passed_query                         = query<GL_ANY_SAMPLES_PASSED>;
 using any_samples_passed_query_conservative            = query<GL_ANY_SAMPLES_PASSED_CONSERVATIVE>;
 using primitives_generated_query                       = query<GL_PRIMITIVES_GENERATED>;
@@ -9,40 +9,42 @@
 #include <array>
 
 #include <gl/opengl.hpp>
+#include <gl/state_cache.hpp>
 
 namespace gl
 {
 // 14.0 Rasterization.
 inline void set_rasterizer_discard_enabled(const bool enabled)
 {
-  enabled ? glEnable(GL_RASTERIZER_DISCARD) : glDisable(GL_RASTERIZER_DISCARD);
+  set_enabled(GL_RASTERIZER_DISCARD, enabled);
 }
 inline bool rasterizer_discard_enabled    ()
 {
-  return glIsEnabled(GL_RASTERIZER_DISCARD) != 0;
+  return is_enabled(GL_RASTERIZER_DISCARD);
 }
 
 // 14.3.1 Multisampling.
 inline void set_multisampling_enabled (const bool enabled)
 {
-  enabled ? glEnable(GL_MULTISAMPLE) : glDisable(GL_MULTISAMPLE);
+  set_enabled(GL_MULTISAMPLE, enabled);
 }
 inline bool multisampling_enabled     ()
 {
-  return glIsEnabled(GL_MULTISAMPLE) != 0;
+  return is_enabled(GL_MULTISAMPLE);
 }
 inline void set_sample_shading_enabled(const bool enabled)
 {
-  enabled ? glEnable(GL_SAMPLE_SHADING) : glDisable(GL_SAMPLE_SHADING);
+  set_enabled(GL_SAMPLE_SHADING, enabled);
 }
 inline bool sample_shading_enabled    ()
 {
-  return glIsEnabled(GL_SAMPLE_SHADING) != 0;
+  return is_enabled(GL_SAMPLE_SHADING);
 }
 
 inline void set_minimum_sample_shading(const GLfloat value = 1.0f)
 {
-  glMinSampleShading(value);
+  if (state_changed(state_cache::parameter::minimum_sample_shading, value))
+    glMinSampleShading(value);
 }
 
 inline std::array<GLfloat, 2> multisample_sample_position(const GLuint index)
@@ -55,101 +57,109 @@ inline std::array<GLfloat, 2> multisample_sample_position(const GLuint index)
 // 14.4 Points.
 inline void set_point_size_enabled(const bool enabled)
 {
-  enabled ? glEnable(GL_PROGRAM_POINT_SIZE) : glDisable(GL_PROGRAM_POINT_SIZE);
+  set_enabled(GL_PROGRAM_POINT_SIZE, enabled);
 }
 inline bool point_size_enabled    ()
 {
-  return glIsEnabled(GL_PROGRAM_POINT_SIZE) != 0;
+  return is_enabled(GL_PROGRAM_POINT_SIZE);
 }
 
 inline void set_point_size               (const GLfloat size   = 1.0f)
 {
-  glPointSize(size);
+  if (state_changed(state_cache::parameter::point_size, size))
+    glPointSize(size);
 }
 inline void set_point_fade_threshold_size(const GLfloat size   = 1.0f)
 {
-  glPointParameterf(GL_POINT_FADE_THRESHOLD_SIZE, size);
+  if (state_changed(state_cache::parameter::point_fade_threshold_size, size))
+    glPointParameterf(GL_POINT_FADE_THRESHOLD_SIZE, size);
 }
 inline void set_point_sprite_coord_origin(const GLenum  origin = GL_UPPER_LEFT)
 {
-  glPointParameteri(GL_POINT_SPRITE_COORD_ORIGIN, origin);
+  if (state_changed(state_cache::parameter::point_sprite_coord_origin, origin))
+    glPointParameteri(GL_POINT_SPRITE_COORD_ORIGIN, origin);
 }
 
 // 14.5 Line segments.
 inline void set_line_smoothing_enabled(const bool enabled)
 {
-  enabled ? glEnable(GL_LINE_SMOOTH) : glDisable(GL_LINE_SMOOTH);
+  set_enabled(GL_LINE_SMOOTH, enabled);
 }
 inline bool line_smoothing_enabled    ()
 {
-  return glIsEnabled(GL_LINE_SMOOTH) != 0;
+  return is_enabled(GL_LINE_SMOOTH);
 }
 
 inline void set_line_width(const GLfloat width)
 {
-  glLineWidth(width);
+  if (state_changed(state_cache::parameter::line_width, width))
+    glLineWidth(width);
 }
 
 // 14.6 Polygons.
 inline void set_polygon_smoothing_enabled   (const bool enabled)
 {
-  enabled ? glEnable(GL_POLYGON_SMOOTH) : glDisable(GL_POLYGON_SMOOTH);
+  set_enabled(GL_POLYGON_SMOOTH, enabled);
 }
 inline bool polygon_smoothing_enabled       ()
 {
-  return glIsEnabled(GL_POLYGON_SMOOTH) != 0;
+  return is_enabled(GL_POLYGON_SMOOTH);
 }
 inline void set_polygon_face_culling_enabled(const bool enabled)
 {
-  enabled ? glEnable(GL_CULL_FACE) : glDisable(GL_CULL_FACE);
+  set_enabled(GL_CULL_FACE, enabled);
 }
 inline bool polygon_face_culling_enabled    ()
 {
-  return glIsEnabled(GL_CULL_FACE) != 0;
+  return is_enabled(GL_CULL_FACE);
 }
 
 inline void set_front_face(const GLenum mode = GL_CCW )
 {
-  glFrontFace(mode);
+  if (state_changed(state_cache::parameter::front_face, mode))
+    glFrontFace(mode);
 }
 inline void set_cull_face (const GLenum mode = GL_BACK)
 {
-  glCullFace(mode);
+  if (state_changed(state_cache::parameter::cull_face, mode))
+    glCullFace(mode);
 }
 
 // 14.6.4 Polygon rasterization and depth offset.
 inline void set_polygon_mode        (const GLenum mode = GL_FILL)
 {
-  glPolygonMode(GL_FRONT_AND_BACK, mode);
+  if (state_changed(state_cache::parameter::polygon_mode, mode))
+    glPolygonMode(GL_FRONT_AND_BACK, mode);
 }
 inline void set_polygon_offset_clamp(const GLfloat factor, const GLfloat units, const GLfloat clamp = 0.0f)
 {
-  glPolygonOffsetClamp(factor, units, clamp);
+  if (state_changed(state_cache::parameter::polygon_offset_clamp, factor, units, clamp))
+    glPolygonOffsetClamp(factor, units, clamp);
 }
 
 inline void set_polygon_point_offset_enabled(const bool enabled)
 {
-  enabled ? glEnable(GL_POLYGON_OFFSET_POINT) : glDisable(GL_POLYGON_OFFSET_POINT);
+  set_enabled(GL_POLYGON_OFFSET_POINT, enabled);
 }
 inline bool polygon_point_offset_enabled    ()
 {
-  return glIsEnabled(GL_POLYGON_OFFSET_POINT) != 0;
+  return is_enabled(GL_POLYGON_OFFSET_POINT);
 }
 inline void set_polygon_line_offset_enabled (const bool enabled)
 {
-  enabled ? glEnable(GL_POLYGON_OFFSET_LINE) : glDisable(GL_POLYGON_OFFSET_LINE);
+  set_enabled(GL_POLYGON_OFFSET_LINE, enabled);
 }
 inline bool polygon_line_offset_enabled     ()
 {
-  return glIsEnabled(GL_POLYGON_OFFSET_LINE) != 0;
+  return is_enabled(GL_POLYGON_OFFSET_LINE);
 }
 inline void set_polygon_fill_offset_enabled (const bool enabled)
 {
-  enabled ? glEnable(GL_POLYGON_OFFSET_FILL) : glDisable(GL_POLYGON_OFFSET_FILL);
+  set_enabled(GL_POLYGON_OFFSET_FILL, enabled);
 }
 inline bool polygon_fill_offset_enabled     ()
 {
-  return glIsEnabled(GL_POLYGON_OFFSET_FILL) != 0;
+  return is_enabled(GL_POLYGON_OFFSET_FILL);
 }
 }
 
@@ -0,0 +1,231 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_RENDER_STATE_HPP
+#define GL_RENDER_STATE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+
+#include <gl/opengl.hpp>
+#include <gl/framebuffer.hpp>
+#include <gl/per_fragment_ops.hpp>
+#include <gl/rasterization.hpp>
+#include <gl/vertex_post_processing_ops.hpp>
+
+namespace gl
+{
+// The defaults match the initial state of a context.
+struct blend_state
+{
+  bool                   enabled           = false;
+  GLenum                 equation_rgb      = GL_FUNC_ADD;
+  GLenum                 equation_alpha    = GL_FUNC_ADD;
+  GLenum                 source_rgb        = GL_ONE;
+  GLenum                 source_alpha      = GL_ONE;
+  GLenum                 destination_rgb   = GL_ZERO;
+  GLenum                 destination_alpha = GL_ZERO;
+  std::array<GLfloat, 4> color             {0.0f, 0.0f, 0.0f, 0.0f};
+};
+struct depth_state
+{
+  bool                   test_enabled      = false;
+  bool                   write_enabled     = true;
+  GLenum                 function          = GL_LESS;
+};
+struct stencil_face_state
+{
+  GLenum                 function          = GL_ALWAYS;
+  GLint                  reference_value   = 0;
+  GLuint                 read_mask         = ~0u;
+  GLuint                 write_mask        = ~0u;
+  GLenum                 stencil_fail      = GL_KEEP;
+  GLenum                 depth_fail        = GL_KEEP;
+  GLenum                 depth_success     = GL_KEEP;
+};
+struct stencil_state
+{
+  bool                   test_enabled      = false;
+  stencil_face_state     front             ;
+  stencil_face_state     back              ;
+};
+struct raster_state
+{
+  bool                   cull_enabled      = false;
+  GLenum                 cull_face         = GL_BACK;
+  GLenum                 front_face        = GL_CCW;
+  GLenum                 polygon_mode      = GL_FILL;
+  bool                   offset_enabled    = false; // GL_POLYGON_OFFSET_FILL.
+  GLfloat                offset_factor     = 0.0f;
+  GLfloat                offset_units      = 0.0f;
+  GLfloat                offset_clamp      = 0.0f;
+  bool                   depth_clamp       = false;
+};
+struct scissor_state
+{
+  bool                   enabled           = false;
+  std::array<GLint  , 2> offset            {0, 0};
+  std::array<GLsizei, 2> size              {0, 0};
+};
+
+// A description of the fixed-function state used by a draw. apply() sets it in a fixed order through the functions this is
+// built on, which diff against (and update) the state cache current on the calling thread, hence only the calls which differ
+// from the shadowed state are issued. Without a current state cache, every call is issued.
+struct render_state
+{
+  enum difference_bit : std::uint32_t
+  {
+    blend_enabled_bit      = 1u << 0 ,
+    blend_equation_bit     = 1u << 1 ,
+    blend_function_bit     = 1u << 2 ,
+    blend_color_bit        = 1u << 3 ,
+    depth_test_bit         = 1u << 4 ,
+    depth_write_bit        = 1u << 5 ,
+    depth_function_bit     = 1u << 6 ,
+    stencil_test_bit       = 1u << 7 ,
+    stencil_function_bit   = 1u << 8 ,
+    stencil_operation_bit  = 1u << 9 ,
+    stencil_write_mask_bit = 1u << 10,
+    cull_enabled_bit       = 1u << 11,
+    cull_face_bit          = 1u << 12,
+    front_face_bit         = 1u << 13,
+    polygon_mode_bit       = 1u << 14,
+    offset_enabled_bit     = 1u << 15,
+    offset_bit             = 1u << 16,
+    depth_clamp_bit        = 1u << 17,
+    scissor_test_bit       = 1u << 18,
+    scissor_box_bit        = 1u << 19,
+    color_mask_bit         = 1u << 20,
+    all_bits               = (1u << 21) - 1
+  };
+
+  // Returns the difference_bits of the groups of state which differ between this and that.
+  [[nodiscard]]
+  std::uint32_t difference(const render_state& that) const
+  {
+    std::uint32_t result = 0;
+    const auto    mark   = [&] (const bool differs, const difference_bit bit) { if (differs) result |= bit; };
+
+    mark(blend.enabled != that.blend.enabled, blend_enabled_bit);
+    mark(blend.equation_rgb    != that.blend.equation_rgb    || blend.equation_alpha    != that.blend.equation_alpha   , blend_equation_bit);
+    mark(blend.source_rgb      != that.blend.source_rgb      || blend.source_alpha      != that.blend.source_alpha      ||
+         blend.destination_rgb != that.blend.destination_rgb || blend.destination_alpha != that.blend.destination_alpha, blend_function_bit);
+    mark(blend.color != that.blend.color, blend_color_bit);
+
+    mark(depth.test_enabled  != that.depth.test_enabled , depth_test_bit    );
+    mark(depth.write_enabled != that.depth.write_enabled, depth_write_bit   );
+    mark(depth.function      != that.depth.function     , depth_function_bit);
+
+    mark(stencil.test_enabled != that.stencil.test_enabled, stencil_test_bit);
+    for (const auto& [lhs, rhs] : {std::make_pair(&stencil.front, &that.stencil.front), std::make_pair(&stencil.back, &that.stencil.back)})
+    {
+      mark(lhs->function     != rhs->function     || lhs->reference_value != rhs->reference_value || lhs->read_mask     != rhs->read_mask    , stencil_function_bit  );
+      mark(lhs->stencil_fail != rhs->stencil_fail || lhs->depth_fail      != rhs->depth_fail      || lhs->depth_success != rhs->depth_success, stencil_operation_bit );
+      mark(lhs->write_mask   != rhs->write_mask                                                                                            , stencil_write_mask_bit);
+    }
+
+    mark(raster.cull_enabled   != that.raster.cull_enabled  , cull_enabled_bit  );
+    mark(raster.cull_face      != that.raster.cull_face     , cull_face_bit     );
+    mark(raster.front_face     != that.raster.front_face    , front_face_bit    );
+    mark(raster.polygon_mode   != that.raster.polygon_mode  , polygon_mode_bit  );
+    mark(raster.offset_enabled != that.raster.offset_enabled, offset_enabled_bit);
+    mark(raster.offset_factor  != that.raster.offset_factor || raster.offset_units != that.raster.offset_units || raster.offset_clamp != that.raster.offset_clamp, offset_bit);
+    mark(raster.depth_clamp    != that.raster.depth_clamp   , depth_clamp_bit   );
+
+    mark(scissor.enabled != that.scissor.enabled                                    , scissor_test_bit);
+    mark(scissor.offset  != that.scissor.offset || scissor.size != that.scissor.size, scissor_box_bit );
+
+    mark(color_mask != that.color_mask, color_mask_bit);
+    return result;
+  }
+  // FNV-1a over every member, suitable as a sort or lookup key.
+  [[nodiscard]]
+  std::uint64_t hash      () const
+  {
+    std::uint64_t result = 14695981039346656037ull;
+    const auto    feed   = [&] (const auto& value)
+    {
+      const auto* bytes = reinterpret_cast<const std::uint8_t*>(&value);
+      for (std::size_t i = 0; i < sizeof value; ++i)
+        result = (result ^ bytes[i]) * 1099511628211ull;
+    };
+
+    feed(blend.enabled); feed(blend.equation_rgb); feed(blend.equation_alpha); feed(blend.source_rgb); feed(blend.source_alpha);
+    feed(blend.destination_rgb); feed(blend.destination_alpha); feed(blend.color);
+    feed(depth.test_enabled); feed(depth.write_enabled); feed(depth.function);
+    feed(stencil.test_enabled);
+    for (const auto* face : {&stencil.front, &stencil.back})
+    {
+      feed(face->function); feed(face->reference_value); feed(face->read_mask); feed(face->write_mask);
+      feed(face->stencil_fail); feed(face->depth_fail); feed(face->depth_success);
+    }
+    feed(raster.cull_enabled); feed(raster.cull_face); feed(raster.front_face); feed(raster.polygon_mode);
+    feed(raster.offset_enabled); feed(raster.offset_factor); feed(raster.offset_units); feed(raster.offset_clamp); feed(raster.depth_clamp);
+    feed(scissor.enabled); feed(scissor.offset); feed(scissor.size);
+    feed(color_mask);
+    return result;
+  }
+
+  bool operator==(const render_state& that) const
+  {
+    return difference(that) == 0;
+  }
+  bool operator!=(const render_state& that) const
+  {
+    return difference(that) != 0;
+  }
+
+  static void apply(const render_state& next)
+  {
+    next.set(all_bits);
+  }
+
+  blend_state          blend      ;
+  depth_state          depth      ;
+  stencil_state        stencil    ;
+  raster_state         raster     ;
+  scissor_state        scissor    ;
+  std::array<bool, 4>  color_mask {true, true, true, true};
+
+protected:
+  void set(const std::uint32_t bits) const
+  {
+    if (bits & blend_enabled_bit     ) set_blending_enabled(blend.enabled);
+    if (bits & blend_equation_bit    ) set_blend_equation  (blend.equation_rgb, blend.equation_alpha);
+    if (bits & blend_function_bit    ) set_blend_function  (blend.source_rgb, blend.source_alpha, blend.destination_rgb, blend.destination_alpha);
+    if (bits & blend_color_bit       ) set_blend_color     (blend.color);
+
+    if (bits & depth_test_bit        ) set_depth_test_enabled(depth.test_enabled );
+    if (bits & depth_write_bit       ) set_depth_mask        (depth.write_enabled);
+    if (bits & depth_function_bit    ) set_depth_function    (depth.function     );
+
+    if (bits & stencil_test_bit      ) set_stencil_test_enabled(stencil.test_enabled);
+    for (const auto& [face, state] : {std::make_pair(GLenum(GL_FRONT), &stencil.front), std::make_pair(GLenum(GL_BACK), &stencil.back)})
+    {
+      if (bits & stencil_function_bit  ) set_stencil_function (state->function, state->reference_value, state->read_mask, face);
+      if (bits & stencil_operation_bit ) set_stencil_operation(state->stencil_fail, state->depth_fail, state->depth_success, face);
+      if (bits & stencil_write_mask_bit) set_stencil_mask     (state->write_mask, face);
+    }
+
+    if (bits & cull_enabled_bit      ) set_polygon_face_culling_enabled(raster.cull_enabled);
+    if (bits & cull_face_bit         ) set_cull_face                   (raster.cull_face   );
+    if (bits & front_face_bit        ) set_front_face                  (raster.front_face  );
+    if (bits & polygon_mode_bit      ) set_polygon_mode                (raster.polygon_mode);
+    if (bits & offset_enabled_bit    ) set_polygon_fill_offset_enabled (raster.offset_enabled);
+    if (bits & offset_bit            ) set_polygon_offset_clamp        (raster.offset_factor, raster.offset_units, raster.offset_clamp);
+    if (bits & depth_clamp_bit       ) set_depth_clamp_enabled         (raster.depth_clamp );
+
+    if (bits & scissor_test_bit      ) set_scissor_test_enabled(scissor.enabled);
+    if (bits & scissor_box_bit       ) set_scissor             (scissor.offset, scissor.size);
+
+    if (bits & color_mask_bit        ) set_color_mask(color_mask);
+  }
+};
+}
+
+#endif
@@ -6,10 +6,13 @@
 #ifndef GL_SAMPLER_HPP
 #define GL_SAMPLER_HPP
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 
 #include <gl/opengl.hpp>
+#include <gl/state_cache.hpp>
+#include <gl/span.hpp>
 
 namespace gl
 {
@@ -47,7 +50,10 @@ public:
   virtual ~sampler  ()
   {
     if (managed_ && id_ != invalid_id)
+    {
+      forget_object(GL_SAMPLER, id_);
       glDeleteSamplers(1, &id_);
+    }
   }
   sampler& operator=(const sampler&  that)
   {
@@ -69,7 +75,10 @@ public:
     if (this != &temp)
     {
       if (managed_ && id_ != invalid_id)
+      {
+        forget_object(GL_SAMPLER, id_);
         glDeleteSamplers(1, &id_);
+      }
   
       id_      = temp.id_;
       managed_ = temp.managed_;
@@ -82,11 +91,13 @@ public:
 
   void        bind    (const GLuint unit) const
   {
-    glBindSampler(unit, id_);
+    if (sampler_unit_changed(unit, id_))
+      glBindSampler(unit, id_);
   }
   static void unbind  (const GLuint unit)
   {
-    glBindSampler(unit, 0);
+    if (sampler_unit_changed(unit, 0))
+      glBindSampler(unit, 0);
   }
 
   [[nodiscard]]
@@ -260,6 +271,50 @@ protected:
   GLuint id_      = invalid_id;
   bool   managed_ = true;
 };
+
+// A non-owning reference to a sampler. Default constructed references unbind.
+class sampler_ref
+{
+public:
+  sampler_ref() = default;
+  sampler_ref(const sampler& sampler) : id_(sampler.id())
+  {
+
+  }
+
+  [[nodiscard]]
+  GLuint id() const
+  {
+    return id_;
+  }
+
+protected:
+  GLuint id_ = 0;
+};
+
+// 8.2 Sampler objects - Multi-bind. Each batch of up to 32 units is bound by a single call, skipping the units at either end
+// which are already in place according to the state cache.
+inline void bind_samplers(const GLuint first, const span<const sampler_ref> samplers)
+{
+  std::array<GLuint, 32> ids;
+  for (std::size_t offset = 0; offset < samplers.size(); offset += ids.size())
+  {
+    const auto  count = std::min(ids.size(), samplers.size() - offset);
+    const auto  unit  = first + static_cast<GLuint>(offset);
+    std::size_t begin = count, end = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      ids[i] = samplers[offset + i].id();
+      if (sampler_unit_changed(unit + static_cast<GLuint>(i), ids[i]))
+      {
+        begin = std::min(begin, i);
+        end   = i + 1;
+      }
+    }
+    if (begin < end)
+      glBindSamplers(unit + static_cast<GLuint>(begin), static_cast<GLsizei>(end - begin), ids.data() + begin);
+  }
+}
 }
 
 #endif
@@ -12,10 +12,22 @@
 #include <vector>
 
 #include <gl/opengl.hpp>
+#include <gl/state.hpp>
 #include <gl/unmanaged.hpp>
 
 namespace gl
 {
+// Whether ARB_parallel_shader_compile is supported, queried once. Without it, the completion status queries raise GL_INVALID_ENUM.
+inline bool parallel_shader_compile_supported()
+{
+#ifdef GL_ARB_parallel_shader_compile
+  static const auto result = has_extension("GL_ARB_parallel_shader_compile");
+  return result;
+#else
+  return false;
+#endif
+}
+
 class shader
 {
 public:
@@ -65,6 +77,10 @@ public:
   {
     glShaderBinary(1, &id_, format, static_cast<const void*>(binary.data()), static_cast<GLsizei>(binary.size()));
   }
+  void set_binary(const void* binary, const GLsizei size, const GLenum format = GL_SHADER_BINARY_FORMAT_SPIR_V) const
+  {
+    glShaderBinary(1, &id_, format, binary, size);
+  }
   void specialize(const std::string& entry_point, const std::vector<std::tuple<GLuint, GLuint>>& index_value_pairs) const
   {
     std::vector<GLuint> indices;
@@ -79,13 +95,18 @@ public:
     glSpecializeShader(id_, entry_point.c_str(), static_cast<GLuint>(index_value_pairs.size()), indices.data(), values.data());
   }
   [[nodiscard]]
-  bool compile   () const
+  bool compile      () const
   {
-    glCompileShader(id_);
+    begin_compile();
     return compile_status();
   }
+  // Returns without waiting for the compiler; poll completion_status() (ARB_parallel_shader_compile) before compile_status().
+  void begin_compile() const
+  {
+    glCompileShader(id_);
+  }
   [[nodiscard]]
-  bool is_valid  () const
+  bool is_valid     () const
   {
     return glIsShader(id_) != 0;
   }
@@ -113,6 +134,17 @@ public:
   {
     return get_parameter(GL_COMPILE_STATUS) != 0;
   }
+  // Whether compilation has finished, hence compile_status() would not block. Always true without ARB_parallel_shader_compile.
+  [[nodiscard]]
+  bool        completion_status() const
+  {
+    GLint result = GL_TRUE;
+#ifdef GL_ARB_parallel_shader_compile
+    if (parallel_shader_compile_supported())
+      glGetShaderiv(id_, GL_COMPLETION_STATUS_ARB, &result);
+#endif
+    return result != 0;
+  }
   [[nodiscard]]
   bool        delete_status   () const
   {
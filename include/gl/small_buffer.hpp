@@ -0,0 +1,68 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_SMALL_BUFFER_HPP
+#define GL_SMALL_BUFFER_HPP
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace gl
+{
+// Scratch storage for the arrays the wrappers have to convert before passing to GL (e.g. pointers from strings, ids from
+// handles). Up to capacity elements live on the stack; larger sizes fall back to the heap.
+template <typename type, std::size_t capacity = 32>
+class small_buffer
+{
+public:
+  static_assert(std::is_trivially_copyable_v<type>, "Small buffer elements must be trivially copyable.");
+
+  explicit small_buffer  (const std::size_t size) : size_(size)
+  {
+    if (size_ > capacity)
+      heap_.resize(size_);
+  }
+  small_buffer           (const small_buffer&  that) = delete;
+  small_buffer           (      small_buffer&& temp) = delete;
+  ~small_buffer          ()                          = default;
+  small_buffer& operator=(const small_buffer&  that) = delete;
+  small_buffer& operator=(      small_buffer&& temp) = delete;
+
+  [[nodiscard]]
+  type*       data      ()
+  {
+    return size_ > capacity ? heap_.data() : stack_.data();
+  }
+  [[nodiscard]]
+  std::size_t size      () const
+  {
+    return size_;
+  }
+  [[nodiscard]]
+  type*       begin     ()
+  {
+    return data();
+  }
+  [[nodiscard]]
+  type*       end       ()
+  {
+    return data() + size_;
+  }
+  [[nodiscard]]
+  type&       operator[](const std::size_t index)
+  {
+    return data()[index];
+  }
+
+protected:
+  std::size_t                size_ ;
+  std::array<type, capacity> stack_;
+  std::vector<type>          heap_ ;
+};
+}
+
+#endif
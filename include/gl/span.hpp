@@ -0,0 +1,100 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_SPAN_HPP
+#define GL_SPAN_HPP
+
+#include <cstddef>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+namespace gl
+{
+// A non-owning view of contiguous elements (a subset of C++20 std::span), accepted by the functions which pass arrays to GL
+// so that callers are not forced to allocate a std::vector. Constructible from a pointer and count, a C array, any container
+// with data() and size() (std::array, std::vector, std::string, another span) and, for spans of const, a braced list.
+template <typename type>
+class span
+{
+public:
+  using element_type = type;
+  using value_type   = std::remove_cv_t<type>;
+  using iterator     = type*;
+
+  constexpr span  () noexcept = default;
+  constexpr span  (type* data, const std::size_t size) noexcept : data_(data), size_(size)
+  {
+
+  }
+  template <std::size_t size>
+  constexpr span  (type (&array)[size]) noexcept : data_(array), size_(size)
+  {
+
+  }
+  template <typename container, typename = std::enable_if_t<
+    !std::is_same_v<std::decay_t<container>, span> &&
+    std::is_convertible_v<decltype(std::declval<container&>().data()), type*>>>
+  constexpr span  (container&& that) noexcept : data_(that.data()), size_(static_cast<std::size_t>(that.size()))
+  {
+
+  }
+  // The list must outlive the span, which holds when the span is a function argument.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winit-list-lifetime"
+#endif
+  template <typename t = type, typename = std::enable_if_t<std::is_const_v<t>>>
+  constexpr span  (std::initializer_list<value_type> list) noexcept : data_(list.begin()), size_(list.size())
+  {
+
+  }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+  [[nodiscard]]
+  constexpr type*       data      ()                         const noexcept
+  {
+    return data_;
+  }
+  [[nodiscard]]
+  constexpr std::size_t size      ()                         const noexcept
+  {
+    return size_;
+  }
+  [[nodiscard]]
+  constexpr bool        empty     ()                         const noexcept
+  {
+    return size_ == 0;
+  }
+  [[nodiscard]]
+  constexpr iterator    begin     ()                         const noexcept
+  {
+    return data_;
+  }
+  [[nodiscard]]
+  constexpr iterator    end       ()                         const noexcept
+  {
+    return data_ + size_;
+  }
+  [[nodiscard]]
+  constexpr type&       operator[](const std::size_t index)  const noexcept
+  {
+    return data_[index];
+  }
+  [[nodiscard]]
+  constexpr span        subspan   (const std::size_t offset, const std::size_t count) const noexcept
+  {
+    return span(data_ + offset, count);
+  }
+
+protected:
+  type*       data_ = nullptr;
+  std::size_t size_ = 0;
+};
+}
+
+#endif
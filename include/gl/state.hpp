@@ -153,6 +153,17 @@ inline std::vector<std::string> extensions               ()
     result.emplace_back(reinterpret_cast<char const*>(glGetStringi(GL_EXTENSIONS, i)));
   return result;
 }
+// Whether the context supports the extension, without building the list of extensions.
+inline bool                     has_extension            (const std::string& name)
+{
+  GLint count;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+  for (auto i = 0; i < count; i++)
+    if (name == reinterpret_cast<char const*>(glGetStringi(GL_EXTENSIONS, i)))
+      return true;
+  return false;
+}
 inline std::vector<std::string> shading_language_versions()
 {
   GLint count;
@@ -0,0 +1,465 @@
+//          Copyright Ali Can Demiralp 2016 - 2021.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GL_STATE_CACHE_HPP
+#define GL_STATE_CACHE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <gl/opengl.hpp>
+
+namespace gl
+{
+struct state_cache_statistics
+{
+  std::size_t issued_calls = 0; // Calls forwarded to GL, including queries of unknown state.
+  std::size_t elided_calls = 0; // Redundant setters skipped and getters answered from the cache.
+};
+
+// Shadows the capabilities and fixed-function state set through the free functions of per_fragment_ops.hpp, rasterization.hpp,
+// viewport.hpp and vertex_post_processing_ops.hpp and the write masks of framebuffer.hpp, so that redundant setters are skipped and capability getters are answered
+// without glIsEnabled. Also tracks the objects bound through program::use, vertex_array::bind, framebuffer::bind,
+// texture::bind_unit, sampler::bind and buffer::bind_base / bind_range, so that binds which are already in place are skipped.
+// Opt-in: the functions only consult the cache made current on the calling thread, which should be the thread of the context
+// it shadows (one cache per context). All state starts unknown; call invalidate() after GL state is changed behind the cache's
+// back (e.g. by third-party code).
+class state_cache
+{
+public:
+  enum class parameter : std::size_t
+  {
+    scissor,
+    sample_coverage,
+    stencil_function_front,
+    stencil_function_back,
+    stencil_operation_front,
+    stencil_operation_back,
+    depth_function,
+    blend_equation,
+    blend_function,
+    blend_color,
+    logic_operation,
+    minimum_sample_shading,
+    point_size,
+    point_fade_threshold_size,
+    point_sprite_coord_origin,
+    line_width,
+    front_face,
+    cull_face,
+    polygon_mode,
+    polygon_offset_clamp,
+    depth_range,
+    viewport,
+    provoking_vertex,
+    clip_control,
+    color_mask,
+    depth_mask,
+    stencil_mask_front,
+    stencil_mask_back,
+    count
+  };
+  enum class binding : std::size_t
+  {
+    program,
+    vertex_array,
+    draw_framebuffer,
+    read_framebuffer,
+    count
+  };
+
+  state_cache           ()
+  {
+    invalidate();
+  }
+  state_cache           (const state_cache&  that) = delete;
+  state_cache           (      state_cache&& temp) = delete;
+  virtual ~state_cache  ()
+  {
+    if (current() == this)
+      set_current(nullptr);
+  }
+  state_cache& operator=(const state_cache&  that) = delete;
+  state_cache& operator=(      state_cache&& temp) = delete;
+
+  [[nodiscard]]
+  static state_cache* current    ()
+  {
+    return current_pointer();
+  }
+  static void         set_current(state_cache* cache)
+  {
+    current_pointer() = cache;
+  }
+  void                make_current()
+  {
+    set_current(this);
+  }
+
+  void invalidate()
+  {
+    capabilities_.fill(capability_state::unknown);
+    for (auto& value : values_)
+      value.valid = false;
+    bindings_.fill(invalid_id);
+    invalidate_texture_units();
+    sampler_units_.assign(sampler_units_.size(), invalid_id);
+    for (auto& ranges : buffer_ranges_)
+      ranges.assign(ranges.size(), buffer_range());
+  }
+  void invalidate(const GLenum    capability)
+  {
+    const auto index = capability_index(capability);
+    if (index < capabilities_.size())
+      capabilities_[index] = capability_state::unknown;
+  }
+  void invalidate(const parameter parameter )
+  {
+    values_[static_cast<std::size_t>(parameter)].valid = false;
+  }
+
+  // For binds through glBindTexture, which alter the (untracked) active texture unit.
+  void invalidate_texture_units()
+  {
+    texture_units_.assign(texture_units_.size(), invalid_id);
+  }
+  // For changes of the indexed bindings of a target behind the cache, e.g. binding a transform feedback object, which carries its
+  // own GL_TRANSFORM_FEEDBACK_BUFFER bindings.
+  void invalidate_buffer_bindings(const GLenum target)
+  {
+    const auto target_index = indexed_buffer_target_index(target);
+    if (target_index < buffer_ranges_.size())
+      buffer_ranges_[target_index].assign(buffer_ranges_[target_index].size(), buffer_range());
+  }
+  // Called before an object is deleted. GL reverts the bindings of a deleted object (other than a program) to zero, yet the
+  // entries are marked unknown instead, which keeps the tracked state consistent regardless.
+  void forget_object           (const GLenum identifier, const GLuint id)
+  {
+    const auto forget = [id] (GLuint& entry) { if (entry == id) entry = invalid_id; };
+    switch (identifier)
+    {
+    case GL_PROGRAM     : forget(bindings_[static_cast<std::size_t>(binding::program)]);      break;
+    case GL_VERTEX_ARRAY: forget(bindings_[static_cast<std::size_t>(binding::vertex_array)]); break;
+    case GL_FRAMEBUFFER :
+      forget(bindings_[static_cast<std::size_t>(binding::draw_framebuffer)]);
+      forget(bindings_[static_cast<std::size_t>(binding::read_framebuffer)]);
+      break;
+    case GL_TEXTURE     : for (auto& unit : texture_units_) forget(unit); break;
+    case GL_SAMPLER     : for (auto& unit : sampler_units_) forget(unit); break;
+    case GL_BUFFER      :
+      for (auto& ranges : buffer_ranges_)
+        for (auto& range : ranges)
+          if (range.id == id)
+            range = buffer_range();
+      break;
+    default: break;
+    }
+  }
+
+  // Returns true if the capability has to be set (i.e. it differs from or is not known to the cache).
+  [[nodiscard]]
+  bool update_capability(const GLenum capability, const bool enabled)
+  {
+    const auto index = capability_index(capability);
+    const auto state = enabled ? capability_state::enabled : capability_state::disabled;
+    if (index < capabilities_.size())
+    {
+      if (capabilities_[index] == state)
+        return record(false);
+      capabilities_[index] = state;
+    }
+    return record(true);
+  }
+  [[nodiscard]]
+  bool capability       (const GLenum capability)
+  {
+    const auto index = capability_index(capability);
+    if (index < capabilities_.size() && capabilities_[index] != capability_state::unknown)
+    {
+      record(false);
+      return capabilities_[index] == capability_state::enabled;
+    }
+
+    const auto enabled = glIsEnabled(capability) != 0;
+    if (index < capabilities_.size())
+      capabilities_[index] = enabled ? capability_state::enabled : capability_state::disabled;
+    record(true);
+    return enabled;
+  }
+  // Returns true if the parameter has to be set. The values are compared bitwise.
+  template <typename... types>
+  [[nodiscard]]
+  bool update           (const parameter parameter, const types&... values)
+  {
+    return record(store(parameter, values...));
+  }
+  // As update(), for state which is separate for front and back faces. Counts as a single call.
+  template <typename... types>
+  [[nodiscard]]
+  bool update_faces     (const parameter front, const parameter back, const GLenum face, const types&... values)
+  {
+    const auto front_changed = face != GL_BACK  && store(front, values...);
+    const auto back_changed  = face != GL_FRONT && store(back , values...);
+    return record(front_changed || back_changed);
+  }
+
+  // Returns true if the object has to be bound.
+  [[nodiscard]]
+  bool update_binding       (const binding binding, const GLuint id)
+  {
+    auto& entry = bindings_[static_cast<std::size_t>(binding)];
+    if (entry == id && id != invalid_id)
+      return record(false);
+    entry = id;
+    return record(true);
+  }
+  // GL_FRAMEBUFFER binds both the draw and read framebuffers.
+  [[nodiscard]]
+  bool update_framebuffer   (const GLenum target, const GLuint id)
+  {
+    auto&      draw         = bindings_[static_cast<std::size_t>(binding::draw_framebuffer)];
+    auto&      read         = bindings_[static_cast<std::size_t>(binding::read_framebuffer)];
+    const auto draw_changed = target != GL_READ_FRAMEBUFFER && (draw != id || id == invalid_id);
+    const auto read_changed = target != GL_DRAW_FRAMEBUFFER && (read != id || id == invalid_id);
+    if (target != GL_READ_FRAMEBUFFER) draw = id;
+    if (target != GL_DRAW_FRAMEBUFFER) read = id;
+    return record(draw_changed || read_changed);
+  }
+  [[nodiscard]]
+  bool update_texture_unit  (const GLuint unit, const GLuint id)
+  {
+    return record(update_unit(texture_units_, unit, id));
+  }
+  [[nodiscard]]
+  bool update_sampler_unit  (const GLuint unit, const GLuint id)
+  {
+    return record(update_unit(sampler_units_, unit, id));
+  }
+  // Whole-buffer (bind_base) bindings are passed with a size of -1. Targets other than the indexed ones are not tracked.
+  [[nodiscard]]
+  bool update_buffer_binding(const GLenum target, const GLuint index, const GLuint id, const GLintptr offset, const GLsizeiptr size)
+  {
+    const auto target_index = indexed_buffer_target_index(target);
+    if (target_index >= buffer_ranges_.size() || id == invalid_id)
+      return record(true);
+
+    auto& ranges = buffer_ranges_[target_index];
+    if (index >= ranges.size())
+      ranges.resize(index + 1);
+
+    const auto range = id != 0 ? buffer_range {id, offset, size} : buffer_range {0, 0, -1};
+    if (ranges[index].id == range.id && ranges[index].offset == range.offset && ranges[index].size == range.size)
+      return record(false);
+    ranges[index] = range;
+    return record(true);
+  }
+
+  [[nodiscard]]
+  const state_cache_statistics& statistics      () const
+  {
+    return statistics_;
+  }
+  void                          reset_statistics()
+  {
+    statistics_ = state_cache_statistics();
+  }
+
+protected:
+  enum class capability_state : std::uint8_t
+  {
+    unknown,
+    disabled,
+    enabled
+  };
+
+  struct value
+  {
+    bool                          valid = false;
+    std::array<std::uint8_t, 16>  bytes {};
+  };
+
+  struct buffer_range
+  {
+    GLuint     id     = invalid_id;
+    GLintptr   offset = 0;
+    GLsizeiptr size   = -1;
+  };
+
+  static std::size_t   indexed_buffer_target_index(const GLenum target)
+  {
+    switch (target)
+    {
+    case GL_UNIFORM_BUFFER           : return 0;
+    case GL_SHADER_STORAGE_BUFFER    : return 1;
+    case GL_ATOMIC_COUNTER_BUFFER    : return 2;
+    case GL_TRANSFORM_FEEDBACK_BUFFER: return 3;
+    default                          : return static_cast<std::size_t>(-1);
+    }
+  }
+  // The unit tables grow on first use of a unit.
+  static bool          update_unit(std::vector<GLuint>& units, const GLuint unit, const GLuint id)
+  {
+    if (unit >= units.size())
+      units.resize(unit + 1, invalid_id);
+    if (units[unit] == id && id != invalid_id)
+      return false;
+    units[unit] = id;
+    return true;
+  }
+
+  static state_cache*& current_pointer ()
+  {
+    static thread_local state_cache* cache = nullptr;
+    return cache;
+  }
+  static std::size_t   capability_index(const GLenum capability)
+  {
+    switch (capability)
+    {
+    case GL_SCISSOR_TEST            : return  0;
+    case GL_SAMPLE_ALPHA_TO_COVERAGE: return  1;
+    case GL_SAMPLE_ALPHA_TO_ONE     : return  2;
+    case GL_SAMPLE_COVERAGE         : return  3;
+    case GL_SAMPLE_MASK             : return  4;
+    case GL_STENCIL_TEST            : return  5;
+    case GL_DEPTH_TEST              : return  6;
+    case GL_FRAMEBUFFER_SRGB        : return  7;
+    case GL_BLEND                   : return  8;
+    case GL_DITHER                  : return  9;
+    case GL_COLOR_LOGIC_OP          : return 10;
+    case GL_RASTERIZER_DISCARD      : return 11;
+    case GL_MULTISAMPLE             : return 12;
+    case GL_SAMPLE_SHADING          : return 13;
+    case GL_PROGRAM_POINT_SIZE      : return 14;
+    case GL_LINE_SMOOTH             : return 15;
+    case GL_POLYGON_SMOOTH          : return 16;
+    case GL_CULL_FACE               : return 17;
+    case GL_POLYGON_OFFSET_POINT    : return 18;
+    case GL_POLYGON_OFFSET_LINE     : return 19;
+    case GL_POLYGON_OFFSET_FILL     : return 20;
+    case GL_DEPTH_CLAMP             : return 21;
+    default:
+      if (capability >= GL_CLIP_DISTANCE0 && capability <= GL_CLIP_DISTANCE7)
+        return 22 + (capability - GL_CLIP_DISTANCE0);
+      return static_cast<std::size_t>(-1);
+    }
+  }
+
+  template <typename... types>
+  bool store (const parameter parameter, const types&... values)
+  {
+    static_assert((sizeof(types) + ... + 0) <= sizeof(value::bytes), "The values of a parameter may not exceed 16 bytes.");
+
+    std::array<std::uint8_t, 16> bytes {};
+    std::size_t                  offset = 0;
+    ((std::memcpy(bytes.data() + offset, &values, sizeof(types)), offset += sizeof(types)), ...);
+
+    auto& entry = values_[static_cast<std::size_t>(parameter)];
+    if (entry.valid && entry.bytes == bytes)
+      return false;
+    entry.valid = true;
+    entry.bytes = bytes;
+    return true;
+  }
+  bool record(const bool issued)
+  {
+    issued ? ++statistics_.issued_calls : ++statistics_.elided_calls;
+    return issued;
+  }
+
+  std::array<capability_state, 30>                                      capabilities_ {};
+  std::array<value, static_cast<std::size_t>(parameter::count)>         values_       {};
+  std::array<GLuint, static_cast<std::size_t>(binding::count)>         bindings_     {};
+  std::vector<GLuint>                                                   texture_units_;
+  std::vector<GLuint>                                                   sampler_units_;
+  std::array<std::vector<buffer_range>, 4>                              buffer_ranges_;
+  state_cache_statistics                                                statistics_   ;
+};
+
+// The functions below route through the current state cache, if any.
+inline void set_enabled     (const GLenum capability, const bool enabled)
+{
+  auto* cache = state_cache::current();
+  if (cache != nullptr && !cache->update_capability(capability, enabled))
+    return;
+  enabled ? glEnable(capability) : glDisable(capability);
+}
+inline bool is_enabled      (const GLenum capability)
+{
+  auto* cache = state_cache::current();
+  return cache != nullptr ? cache->capability(capability) : glIsEnabled(capability) != 0;
+}
+// Returns true if the call setting the parameter to the values has to be issued.
+template <typename... types>
+bool        state_changed   (const state_cache::parameter parameter, const types&... values)
+{
+  auto* cache = state_cache::current();
+  return cache == nullptr || cache->update(parameter, values...);
+}
+template <typename... types>
+bool        state_changed   (const state_cache::parameter front, const state_cache::parameter back, const GLenum face, const types&... values)
+{
+  auto* cache = state_cache::current();
+  return cache == nullptr || cache->update_faces(front, back, face, values...);
+}
+// Returns true if the bind has to be issued.
+inline bool binding_changed        (const state_cache::binding binding, const GLuint id)
+{
+  auto* cache = state_cache::current();
+  return cache == nullptr || cache->update_binding(binding, id);
+}
+inline bool framebuffer_changed    (const GLenum target, const GLuint id)
+{
+  auto* cache = state_cache::current();
+  return cache == nullptr || cache->update_framebuffer(target, id);
+}
+inline bool texture_unit_changed   (const GLuint unit  , const GLuint id)
+{
+  auto* cache = state_cache::current();
+  return cache == nullptr || cache->update_texture_unit(unit, id);
+}
+inline bool sampler_unit_changed   (const GLuint unit  , const GLuint id)
+{
+  auto* cache = state_cache::current();
+  return cache == nullptr || cache->update_sampler_unit(unit, id);
+}
+inline bool buffer_binding_changed (const GLenum target, const GLuint index, const GLuint id, const GLintptr offset = 0, const GLsizeiptr size = -1)
+{
+  auto* cache = state_cache::current();
+  return cache == nullptr || cache->update_buffer_binding(target, index, id, offset, size);
+}
+inline void forget_object          (const GLenum identifier, const GLuint id)
+{
+  if (auto* cache = state_cache::current())
+    cache->forget_object(identifier, id);
+}
+inline void invalidate_texture_units()
+{
+  if (auto* cache = state_cache::current())
+    cache->invalidate_texture_units();
+}
+inline void invalidate_buffer_bindings(const GLenum target)
+{
+  if (auto* cache = state_cache::current())
+    cache->invalidate_buffer_bindings(target);
+}
+
+// For calls which are not shadowed themselves but alter shadowed state (e.g. the indexed variants).
+inline void invalidate_state(const GLenum                 capability)
+{
+  if (auto* cache = state_cache::current())
+    cache->invalidate(capability);
+}
+inline void invalidate_state(const state_cache::parameter parameter )
+{
+  if (auto* cache = state_cache::current())
+    cache->invalidate(parameter);
+}
+}
+
+#endif
@@ -6,14 +6,17 @@
 #ifndef GL_TEXTURE_HPP
 #define GL_TEXTURE_HPP
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <utility>
 #include <vector>
 
 #include <gl/opengl.hpp>
+#include <gl/state_cache.hpp>
 #include <gl/buffer.hpp>
 #include <gl/renderbuffer.hpp>
+#include <gl/span.hpp>
 
 #ifdef GL_CUDA_INTEROP_SUPPORT
   #include <cuda_gl_interop.h>
@@ -58,7 +61,10 @@ public:
   virtual ~texture  ()
   {
     if (managed_ && id_ != invalid_id)
+    {
+      forget_object(GL_TEXTURE, id_);
       glDeleteTextures(1, &id_);
+    }
   }
   texture& operator=(const texture&  that) = delete;
   texture& operator=(      texture&& temp) noexcept
@@ -66,7 +72,10 @@ public:
     if (this != &temp)
     {
       if (managed_ && id_ != invalid_id)
+      {
+        forget_object(GL_TEXTURE, id_);
         glDeleteTextures(1, &id_);
+      }
 
       id_       = temp.id_;
       managed_  = temp.managed_;
@@ -85,15 +94,18 @@ public:
 
   void        bind      () const
   {
+    invalidate_texture_units();
     glBindTexture(target, id_);
   }
   static void unbind    ()
   {
+    invalidate_texture_units();
     glBindTexture(target, 0  );
   }
   void        bind_unit (const GLuint unit) const
   {
-    glBindTextureUnit(unit, id_);
+    if (texture_unit_changed(unit, id_))
+      glBindTextureUnit(unit, id_);
   }
   [[nodiscard]]
   bool        is_valid  () const
@@ -722,6 +734,64 @@ inline bool seamless_cubemap_enabled    ()
 {
   return glIsEnabled(GL_TEXTURE_CUBE_MAP_SEAMLESS) != 0;
 }
+
+// A non-owning reference to a texture of any target. Default constructed references unbind.
+class texture_ref
+{
+public:
+  texture_ref() = default;
+  template<GLenum target>
+  texture_ref(const texture<target>& texture) : id_(texture.id())
+  {
+
+  }
+
+  [[nodiscard]]
+  GLuint id() const
+  {
+    return id_;
+  }
+
+protected:
+  GLuint id_ = 0;
+};
+
+// 8.1 Texture objects - Multi-bind. Each batch of up to 32 units is bound by a single call, skipping the units at either end
+// which are already in place according to the state cache.
+inline void bind_textures      (const GLuint first, const span<const texture_ref> textures)
+{
+  std::array<GLuint, 32> ids;
+  for (std::size_t offset = 0; offset < textures.size(); offset += ids.size())
+  {
+    const auto  count = std::min(ids.size(), textures.size() - offset);
+    const auto  unit  = first + static_cast<GLuint>(offset);
+    std::size_t begin = count, end = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      ids[i] = textures[offset + i].id();
+      if (texture_unit_changed(unit + static_cast<GLuint>(i), ids[i]))
+      {
+        begin = std::min(begin, i);
+        end   = i + 1;
+      }
+    }
+    if (begin < end)
+      glBindTextures(unit + static_cast<GLuint>(begin), static_cast<GLsizei>(end - begin), ids.data() + begin);
+  }
+}
+// 8.26 Texture image loads and stores - Multi-bind. Binds level 0 of each texture, layered, for read and write access, in the
+// format of its level 0.
+inline void bind_image_textures(const GLuint first, const span<const texture_ref> textures)
+{
+  std::array<GLuint, 32> ids;
+  for (std::size_t offset = 0; offset < textures.size(); offset += ids.size())
+  {
+    const auto count = std::min(ids.size(), textures.size() - offset);
+    for (std::size_t i = 0; i < count; ++i)
+      ids[i] = textures[offset + i].id();
+    glBindImageTextures(first + static_cast<GLuint>(offset), static_cast<GLsizei>(count), ids.data());
+  }
+}
 }
 
 #endif
@@ -8,6 +8,7 @@
 
 #include <gl/opengl.hpp>
 #include <gl/buffer.hpp>
+#include <gl/state_cache.hpp>
 
 namespace gl
 {
@@ -32,7 +33,10 @@ public:
   virtual ~transform_feedback  ()
   {
     if (managed_ && id_ != invalid_id)
+    {
+      invalidate_buffer_bindings(GL_TRANSFORM_FEEDBACK_BUFFER);
       glDeleteTransformFeedbacks(1, &id_);
+    }
   }
   transform_feedback& operator=(const transform_feedback&  that) = delete;
   transform_feedback& operator=(      transform_feedback&& temp) noexcept
@@ -40,7 +44,10 @@ public:
     if (this != &temp)
     {
       if (managed_ && id_ != invalid_id)
+      {
+        invalidate_buffer_bindings(GL_TRANSFORM_FEEDBACK_BUFFER);
         glDeleteTransformFeedbacks(1, &id_);
+      }
   
       id_      = temp.id_;
       managed_ = temp.managed_;
@@ -51,12 +58,16 @@ public:
     return *this;
   }
   
+  // Each transform feedback object carries its own GL_TRANSFORM_FEEDBACK_BUFFER bindings, hence (un)binding one, as well as
+  // setting the buffers of or deleting the bound one, invalidates those tracked by the current state cache.
   void        bind    () const
   {
+    invalidate_buffer_bindings(GL_TRANSFORM_FEEDBACK_BUFFER);
     glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, id_);
   }
   static void unbind  ()
   {
+    invalidate_buffer_bindings(GL_TRANSFORM_FEEDBACK_BUFFER);
     glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
   }
   [[nodiscard]]
@@ -67,10 +78,12 @@ public:
 
   void set_buffer_range(const GLuint index, const buffer& buffer, const GLintptr offset, const GLsizeiptr size) const
   {
+    invalidate_buffer_bindings(GL_TRANSFORM_FEEDBACK_BUFFER);
     glTransformFeedbackBufferRange(id_, index, buffer.id(), offset, size);
   }
   void set_buffer_base (const GLuint index, const buffer& buffer) const
   {
+    invalidate_buffer_bindings(GL_TRANSFORM_FEEDBACK_BUFFER);
     glTransformFeedbackBufferBase(id_, index, buffer.id());
   }
   
@@ -6,11 +6,31 @@
 #ifndef GL_VERTEX_ARRAY_HPP
 #define GL_VERTEX_ARRAY_HPP
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
 #include <gl/opengl.hpp>
+#include <gl/state_cache.hpp>
 #include <gl/buffer.hpp>
+#include <gl/span.hpp>
 
 namespace gl
 {
+// A vertex buffer binding for multi-bind. Default constructed bindings unbind.
+struct vertex_buffer_binding
+{
+  vertex_buffer_binding() = default;
+  vertex_buffer_binding(const buffer& buffer, const GLintptr offset, const GLsizei stride) : id(buffer.id()), offset(offset), stride(stride)
+  {
+
+  }
+
+  GLuint   id     = 0;
+  GLintptr offset = 0;
+  GLsizei  stride = 0;
+};
+
 class vertex_array
 {
 public:
@@ -32,7 +52,10 @@ public:
   virtual ~vertex_array  ()
   {
     if (managed_ && id_ != invalid_id)
+    {
+      forget_object(GL_VERTEX_ARRAY, id_);
       glDeleteVertexArrays(1, &id_);
+    }
   }
   vertex_array& operator=(const vertex_array&  that) = delete;
   vertex_array& operator=(      vertex_array&& temp) noexcept
@@ -40,7 +63,10 @@ public:
     if (this != &temp)
     {
       if (managed_ && id_ != invalid_id)
+      {
+        forget_object(GL_VERTEX_ARRAY, id_);
         glDeleteVertexArrays(1, &id_);
+      }
   
       id_      = temp.id_;
       managed_ = temp.managed_;
@@ -53,11 +79,13 @@ public:
 
   void        bind    () const
   {
-    glBindVertexArray(id_);
+    if (binding_changed(state_cache::binding::vertex_array, id_))
+      glBindVertexArray(id_);
   }
   static void unbind  ()
   {
-    glBindVertexArray(0);
+    if (binding_changed(state_cache::binding::vertex_array, 0))
+      glBindVertexArray(0);
   }
   [[nodiscard]]
   bool        is_valid() const
@@ -75,6 +103,24 @@ public:
   {
     glVertexArrayVertexBuffer(id_, binding_index, buffer.id(), offset, stride);
   }
+  // Each batch of up to 32 bindings is set by a single call.
+  void set_vertex_buffers          (const GLuint first, const span<const vertex_buffer_binding> bindings) const
+  {
+    std::array<GLuint  , 32> ids    ;
+    std::array<GLintptr, 32> offsets;
+    std::array<GLsizei , 32> strides;
+    for (std::size_t offset = 0; offset < bindings.size(); offset += ids.size())
+    {
+      const auto count = std::min(ids.size(), bindings.size() - offset);
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        ids    [i] = bindings[offset + i].id;
+        offsets[i] = bindings[offset + i].offset;
+        strides[i] = bindings[offset + i].stride;
+      }
+      glVertexArrayVertexBuffers(id_, first + static_cast<GLuint>(offset), static_cast<GLsizei>(count), ids.data(), offsets.data(), strides.data());
+    }
+  }
   void set_attribute_enabled       (const GLuint index, const bool   enabled      ) const
   {
     enabled ? glEnableVertexArrayAttrib(id_, index) : glDisableVertexArrayAttrib(id_, index);
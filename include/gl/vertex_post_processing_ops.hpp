@@ -7,35 +7,38 @@
 #define GL_VERTEX_POST_PROCESSING_OPS_HPP
 
 #include <gl/opengl.hpp>
+#include <gl/state_cache.hpp>
 
 namespace gl
 {
 // 13.4 Flatshading.
 inline void set_provoking_vertex(const GLenum provoke_mode)
 {
-  glProvokingVertex(provoke_mode);
+  if (state_changed(state_cache::parameter::provoking_vertex, provoke_mode))
+    glProvokingVertex(provoke_mode);
 }
 
 // 13.5 Primitive clipping.
 inline void set_depth_clamp_enabled  (const bool enabled)
 {
-  enabled ? glEnable(GL_DEPTH_CLAMP) : glDisable(GL_DEPTH_CLAMP);
+  set_enabled(GL_DEPTH_CLAMP, enabled);
 }
 inline bool depth_clamp_enabled      ()
 {
-  return glIsEnabled(GL_DEPTH_CLAMP) != 0;
+  return is_enabled(GL_DEPTH_CLAMP);
 }
 inline void set_clip_distance_enabled(const bool enabled , const GLuint index = 0)
 {
-  enabled ? glEnable(GL_CLIP_DISTANCE0 + index) : glDisable(GL_CLIP_DISTANCE0 + index);
+  set_enabled(GL_CLIP_DISTANCE0 + index, enabled);
 }
 inline bool clip_distance_enabled    (                     const GLuint index = 0)
 {
-  return glIsEnabled(GL_CLIP_DISTANCE0 + index) != 0;
+  return is_enabled(GL_CLIP_DISTANCE0 + index);
 }
 inline void set_clip_control         (const GLenum origin, const GLenum depth)
 {
-  glClipControl(origin, depth);
+  if (state_changed(state_cache::parameter::clip_control, origin, depth))
+    glClipControl(origin, depth);
 }
 }
 
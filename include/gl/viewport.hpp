@@ -9,6 +9,7 @@
 #include <array>
 
 #include <gl/opengl.hpp>
+#include <gl/state_cache.hpp>
 
 #ifdef near
 #undef near
@@ -23,22 +24,27 @@ namespace gl
 // 13.6.1 Controlling viewport.
 inline void set_depth_range        (                    const GLdouble near, const GLdouble far)
 {
-  glDepthRange(near, far);
+  if (state_changed(state_cache::parameter::depth_range, near, far))
+    glDepthRange(near, far);
 }
 inline void set_depth_range        (                    const GLfloat  near, const GLfloat  far)
 {
-  glDepthRangef(near, far);
+  if (state_changed(state_cache::parameter::depth_range, static_cast<GLdouble>(near), static_cast<GLdouble>(far)))
+    glDepthRangef(near, far);
 }
 inline void set_indexed_depth_range(const GLuint index, const GLdouble near, const GLdouble far)
 {
+  invalidate_state(state_cache::parameter::depth_range);
   glDepthRangeIndexed(index, near, far);
 }
 inline void set_viewport           (                    const std::array<GLint  , 2>& offset, const std::array<GLsizei, 2>& size)
 {
-  glViewport(offset[0], offset[1], size[0], size[1]);
+  if (state_changed(state_cache::parameter::viewport, offset, size))
+    glViewport(offset[0], offset[1], size[0], size[1]);
 }
 inline void set_indexed_viewport   (const GLuint index, const std::array<GLfloat, 2>& offset, const std::array<GLfloat, 2>& size)
 {
+  invalidate_state(state_cache::parameter::viewport);
   glViewportIndexedf(index, offset[0], offset[1], size[0], size[1]);
 }
 }